@@ -0,0 +1,73 @@
+/*!
+ @file arena.h
+ @brief bump allocator
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __C_ARENA_H__
+#define __C_ARENA_H__
+
+#include "output.h"
+
+#include <stddef.h>
+
+/*!
+ @addtogroup ARENA bump allocator
+ @{
+*/
+
+/*!
+ size of a page, a larger block gets a page of its own
+*/
+#define C_ARENA_PAGE 0x10000
+
+/*!
+ @brief instance structure for bump allocator
+ @details the blocks are never freed one by one, all of them are released together.
+*/
+typedef struct c_arena_s
+{
+    void *__page; /*!< the current page, every page starts with a pointer to the previous one */
+    char *__cur; /*!< the next free byte of the current page */
+    char *__end; /*!< the end of the current page */
+} c_arena_s;
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+c_arena_s *c_arena_new(void);
+
+void c_arena_die(c_arena_s *ctx);
+
+void c_arena_ctor(c_arena_s *ctx);
+
+/*!
+ @brief release every page of the arena at once.
+*/
+void c_arena_dtor(c_arena_s *ctx);
+
+/*!
+ @brief allocate a block aligned to a pointer.
+ @param[in,out] ctx points to an instance of bump allocator
+ @param[in] siz size of the block
+ @return a pointer to the block, or NULL when out of memory
+*/
+void *c_arena_alloc(c_arena_s *ctx, size_t siz);
+
+/*!
+ @brief duplicate a string in the arena.
+ @param[in,out] ctx points to an instance of bump allocator
+ @param[in] str points to a string
+ @param[in] len length of the string
+ @return a pointer to the null-terminated copy, or NULL when out of memory
+*/
+str_t c_arena_strndup(c_arena_s *ctx, cptr_t str, size_t len);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+/*! @} ARENA */
+
+#endif /* __C_ARENA_H__ */
@@ -0,0 +1,99 @@
+/*!
+ @file cols.h
+ @brief columnar snapshot of cipher infomation
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __C_COLS_H__
+#define __C_COLS_H__
+
+#include "info.h"
+
+/*!
+ @brief instance structure for columnar snapshot
+ @details every column is a contiguous array indexed by row, the texts are packed
+  one after another with their nulls. Scans touch only the columns they read.
+  The free slots of the c_info_s are left out, pos maps a row back to its entry.
+*/
+typedef struct c_cols_s
+{
+    char *text; /*!< packed texts */
+    size_t *off; /*!< offset of the text of every row, off[num] is the size of text */
+    size_t *pos; /*!< position of the entry of every row */
+    byte_t *type; /*!< type of every row */
+    byte_t *size; /*!< size of every row */
+    byte_t *hash; /*!< hash id of every row, 0xFF when it is unknown */
+    u64_t *mask; /*!< bit (c & 63) is set for every case folded byte c of the text of every row */
+    size_t num; /*!< number of rows */
+} c_cols_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief a row that matches a fuzzy query and its score
+*/
+typedef struct c_cols_hit_s
+{
+    size_t row;
+    int score;
+} c_cols_hit_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+static inline size_t c_cols_num(const c_cols_s *ctx) { return ctx->num; }
+
+static inline cstr_t c_cols_text(const c_cols_s *ctx, size_t row)
+{
+    return ctx->text + ctx->off[row];
+}
+
+static inline size_t c_cols_len(const c_cols_s *ctx, size_t row)
+{
+    return ctx->off[row + 1] - ctx->off[row] - 1;
+}
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+void c_cols_ctor(c_cols_s *ctx);
+
+void c_cols_dtor(c_cols_s *ctx);
+
+/*!
+ @brief build the snapshot from the entries of info in one pass, replacing the old rows.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_cols_build(c_cols_s *ctx, const c_info_s *info);
+
+/*!
+ @brief find the first row from row on whose text contains str.
+ @return the row, or the number of rows when there is none
+*/
+size_t c_cols_next(const c_cols_s *ctx, size_t row, cstr_t str);
+
+/*!
+ @brief rank the rows whose text holds the bytes of str in order, ignoring case.
+ @details a match scores for every byte, more at the start of a word and for a run
+  of bytes, less for every byte skipped in between. The rows whose text lacks a byte
+  of str are ruled out by their masks first.
+ @param[in] ctx points to an instance of columnar snapshot
+ @param[in] str the query
+ @param[out] top points to k hits, the best first, equal scores in the order of rows
+ @param[in] k the number of best hits to keep
+ @return the number of hits in top
+*/
+size_t c_cols_fuzzy(const c_cols_s *ctx, cstr_t str, c_cols_hit_s *top, size_t k);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* __cplusplus */
+
+#endif /* __C_COLS_H__ */
@@ -0,0 +1,96 @@
+/*!
+ @file gram.h
+ @brief trigram index of strings
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __C_GRAM_H__
+#define __C_GRAM_H__
+
+#include "output.h"
+
+#include <stddef.h>
+
+/*!
+ @addtogroup GRAM trigram index
+ @{
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief posting list of a trigram, the positions of the strings that hold it in ascending order
+*/
+typedef struct c_gram_list_s
+{
+    uint_t *pos;
+    uint_t key; /*!< the three bytes of the trigram + 1, 0 is an empty slot */
+    uint_t num;
+    uint_t mem;
+} c_gram_list_s;
+
+/*!
+ @brief instance structure for trigram index
+ @details every string is split into the overlapping runs of three bytes, a string that
+  contains another one holds all of its trigrams. Intersecting their posting lists leaves
+  the candidates, which still need to be verified. Positions are limited to 32 bits.
+*/
+typedef struct c_gram_s
+{
+    c_gram_list_s *__list; /*!< open addressing table by trigram */
+    size_t __mem; /*!< number of slots, a power of two */
+    size_t __len; /*!< number of used slots */
+} c_gram_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+c_gram_s *c_gram_new(void);
+
+void c_gram_die(c_gram_s *ctx);
+
+void c_gram_ctor(c_gram_s *ctx);
+
+void c_gram_dtor(c_gram_s *ctx);
+
+/*!
+ @brief add the trigrams of str at pos, adding them again does nothing.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_gram_put(c_gram_s *ctx, size_t pos, cstr_t str);
+
+/*!
+ @brief remove the trigrams of str at pos, str must be the string that was added.
+*/
+void c_gram_del(c_gram_s *ctx, size_t pos, cstr_t str);
+
+/*!
+ @brief remove every position from pos on, the memory is kept.
+*/
+void c_gram_cut(c_gram_s *ctx, size_t pos);
+
+/*!
+ @brief find the first position from pos on that holds every trigram of str.
+ @details a str shorter than a trigram is held by every position, so pos is returned.
+  Of a long str, only the first few dozen trigrams are probed.
+ @return the position, or ~0 when there is none
+*/
+size_t c_gram_next(const c_gram_s *ctx, cstr_t str, size_t pos);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* __cplusplus */
+
+/*! @} GRAM */
+
+#endif /* __C_GRAM_H__ */
@@ -0,0 +1,176 @@
+/*!
+ @file index.h
+ @brief text index and slot map of a vector
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __C_INDEX_H__
+#define __C_INDEX_H__
+
+#include "output.h"
+#include "gram.h"
+
+#include <stddef.h>
+
+/*!
+ @addtogroup INDEX text index and slot map
+ @{
+*/
+
+/*!
+ @brief get the text of the element at pos of a vector, NULL for a free slot
+*/
+typedef cstr_t (*c_index_f)(const void *head, size_t pos);
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief instance structure for text index and slot map
+ @details it is kept by a vector whose elements hold a text each, the vector passes
+  its elements to every call and tells it when they move. The elements are indexed
+  by text in a hash table and by trigram, both are built on demand. A free slot is an
+  element without text, the generation of a slot changes whenever its element leaves
+  it, a handle packs the generation above the position.
+*/
+typedef struct c_index_s
+{
+    c_index_f __text; /*!< the text of an element */
+    size_t *__slot; /*!< open addressing by text, every slot is a pair of position + 1 and hash */
+    size_t __mem; /*!< number of slots, a power of two */
+    size_t __len; /*!< number of used slots */
+    size_t __num; /*!< the elements before it are in the hash table */
+    uint_t *__gen; /*!< generations of the elements, as many as the vector holds */
+    size_t *__free; /*!< positions of freed slots, the last freed is reused first */
+    size_t __free_num; /*!< number of positions in __free */
+    size_t __free_mem; /*!< number of positions __gen and __free hold */
+    c_gram_s *__gram; /*!< trigram index of the texts, built by the first c_index_next */
+    size_t __gram_num; /*!< the elements before it are in __gram */
+} c_index_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+static inline size_t c_index_free_num(const c_index_s *ctx) { return ctx->__free_num; }
+
+/*!
+ @brief get the handle of the element at pos.
+*/
+static inline u64_t c_index_id(const c_index_s *ctx, size_t pos)
+{
+    return (u64_t)ctx->__gen[pos] << 32 | (u64_t)pos;
+}
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+void c_index_ctor(c_index_s *ctx, c_index_f text);
+
+void c_index_dtor(c_index_s *ctx);
+
+/*!
+ @brief copy the generations of obj for a copy of its elements, then collect the free slots.
+ @param[in] mem number of elements the vector holds
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_index_copy(c_index_s *ctx, const c_index_s *obj, size_t mem);
+
+/*!
+ @brief resize the generations and the free slots from old to mem elements.
+ @details growing them must succeed before the vector grows, shrinking them may fail.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_index_alloc(c_index_s *ctx, size_t old, size_t mem);
+
+/*!
+ @brief forget every element and every free slot, the memory is kept.
+*/
+void c_index_clear(c_index_s *ctx);
+
+/*!
+ @brief rebuild the hash table from the texts of all elements.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_index_reindex(c_index_s *ctx, const void *head, size_t num);
+
+/*!
+ @brief drop the elements from pos on, after they moved or before they leave.
+*/
+void c_index_cut(c_index_s *ctx, const void *head, size_t pos);
+
+/*!
+ @brief the elements from pos to end leave their slots, so do their handles.
+*/
+void c_index_bump(c_index_s *ctx, size_t pos, size_t end);
+
+/*!
+ @brief collect the free slots again after the elements have moved.
+*/
+void c_index_scan(c_index_s *ctx, const void *head, size_t num);
+
+/*!
+ @brief follow the elements at lhs and rhs before they trade places.
+*/
+void c_index_swap(c_index_s *ctx, const void *head, size_t lhs, size_t rhs);
+
+/*!
+ @brief find the first element whose text is equal to text.
+ @return the position of the element, or num when there is none
+*/
+size_t c_index_find(c_index_s *ctx, const void *head, size_t num, cstr_t text);
+
+/*!
+ @brief remove the element at pos from the index before its text changes.
+*/
+void c_index_forget(c_index_s *ctx, const void *head, size_t pos);
+
+/*!
+ @brief add the element at pos to the index after its text is set.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_index_remember(c_index_s *ctx, const void *head, size_t pos);
+
+/*!
+ @brief take the last freed slot that is still free.
+ @return the position of the slot, or num when there is none
+*/
+size_t c_index_claim(c_index_s *ctx, const void *head, size_t num);
+
+/*!
+ @brief free the slot at pos after its element is destructed.
+*/
+void c_index_erase(c_index_s *ctx, const void *head, size_t num, size_t pos);
+
+/*!
+ @brief get the position of a handle.
+ @return the position, or num when its element has left the slot
+*/
+size_t c_index_get(const c_index_s *ctx, const void *head, size_t num, u64_t id);
+
+/*!
+ @brief find the first candidate from pos on whose text may contain str.
+ @details the candidates hold every trigram of str, they still need to be checked.
+  Without memory for the trigram index, every position is a candidate.
+ @return the position of the candidate, or a position not less than num when there is none
+*/
+size_t c_index_next(c_index_s *ctx, const void *head, size_t num, cstr_t str, size_t pos);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* __cplusplus */
+
+/*! @} INDEX */
+
+#endif /* __C_INDEX_H__ */
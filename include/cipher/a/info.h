@@ -8,6 +8,8 @@
 #define __C_INFO_H__
 
 #include "../cipher.h"
+#include "index.h"
+#include "log.h"
 
 #include <string.h>
 
@@ -27,6 +29,9 @@ typedef struct c_info_s
     cipher_s *head;
     cipher_s *tail;
     cipher_s *last;
+    c_index_s __index[1]; /*!< index by text and by trigram, slot map over the entries */
+    c_arena_s *__arena;   /*!< the fields of the entries added through c_info_add, if any */
+    c_log_s __log[1];     /*!< the texts changed by c_info_add, c_info_del and c_info_erase */
 } c_info_s;
 
 static inline cipher_s *c_info_ptr(const c_info_s *ctx) { return ctx->head; }
@@ -53,6 +58,10 @@ static inline cipher_s *c_info_top(const c_info_s *ctx)
     return ctx->head != ctx->tail ? ctx->tail - 1 : NULL;
 }
 
+static inline c_arena_s *c_info_arena(const c_info_s *ctx) { return ctx->__arena; }
+
+static inline c_log_s *c_info_log(c_info_s *ctx) { return ctx->__log; }
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* __cplusplus */
@@ -85,6 +94,108 @@ cipher_s *c_info_pop_fore(c_info_s *ctx);
 
 cipher_s *c_info_pop_back(c_info_s *ctx);
 
+/*!
+ @brief find the first entry whose text is equal to text through the index.
+ @note the text of an indexed entry must only change through c_info_forget first,
+  or call c_info_reindex after changing it.
+*/
+cipher_s *c_info_find(c_info_s *ctx, cstr_t text);
+
+/*!
+ @brief remove an entry from the index before its text changes.
+*/
+void c_info_forget(c_info_s *ctx, const cipher_s *obj);
+
+/*!
+ @brief rebuild the index from the texts of all entries.
+*/
+int c_info_reindex(c_info_s *ctx);
+
+/*!
+ @brief attach an arena to hold the fields of the entries, for bulk loads.
+ @details the fields are released together by c_info_drop and c_info_dtor,
+  an entry taken out of the vector must be copied rather than moved.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_info_use_arena(c_info_s *ctx);
+
+/*!
+ @brief add an entry to the index after its text is set, the counterpart of c_info_forget.
+*/
+int c_info_remember(c_info_s *ctx, const cipher_s *obj);
+
+/*!
+ @brief get a free slot, the last freed one is reused before the vector grows.
+ @return a constructed entry without text, or NULL when out of memory.
+ @note set the text and call c_info_remember, a reused slot is not indexed on demand.
+*/
+cipher_s *c_info_claim(c_info_s *ctx);
+
+/*!
+ @brief destruct the entry at idx and free its slot, the later entries keep their positions.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 idx is out of range or the slot is already free
+*/
+int c_info_erase(c_info_s *ctx, size_t idx);
+
+/*!
+ @brief get the handle of the entry at idx, it is valid until the entry leaves its slot.
+*/
+u64_t c_info_id(const c_info_s *ctx, size_t idx);
+
+/*!
+ @brief get the entry of a handle.
+ @return NULL when the entry has been erased, moved or popped since the handle was taken.
+*/
+cipher_s *c_info_get(const c_info_s *ctx, u64_t id);
+
+/*!
+ @brief move the entries over the free slots, keeping their order.
+ @return number of slots reclaimed.
+ @note the handles of the entries after the first free slot are invalidated.
+*/
+size_t c_info_compact(c_info_s *ctx);
+
+/*!
+ @brief reserve memory for num entries at once, the memory is not grown geometrically.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_info_reserve(c_info_s *ctx, size_t num);
+
+/*!
+ @brief push n constructed entries at once.
+ @return a pointer to the first of them, or NULL when out of memory.
+*/
+cipher_s *c_info_append_n(c_info_s *ctx, size_t n);
+
+/*!
+ @brief release the memory beyond the entries.
+ @note the generations of the released slots are forgotten, so are the handles of popped entries.
+*/
+int c_info_shrink_to_fit(c_info_s *ctx);
+
+/*!
+ @brief find the first entry from idx on whose text contains str.
+ @details the texts are looked up in a trigram index that is built by the first search,
+  an entry that is added or erased later is indexed by the next one.
+  The text of an indexed entry must only change through c_info_forget first.
+  The index pays off over many searches of entries kept in memory. A store that is not loaded
+  is searched through c_sqlite_match_info instead, which is what the CLI does.
+ @return the position of the entry, or the number of entries when there is none.
+*/
+size_t c_info_search(c_info_s *ctx, cstr_t str, size_t idx);
+
+/*!
+ @brief record in the journal that the entry of text has changed.
+ @details once half of the entries have changed, they are all taken as changed.
+*/
+void c_info_mark(c_info_s *ctx, cstr_t text);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* __cplusplus */
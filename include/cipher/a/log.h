@@ -0,0 +1,81 @@
+/*!
+ @file log.h
+ @brief change journal
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __C_LOG_H__
+#define __C_LOG_H__
+
+#include "output.h"
+
+#include <stddef.h>
+
+/*!
+ @addtogroup LOG change journal
+ @{
+*/
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief instance structure for change journal
+ @details it keeps the keys of the entries that were added, changed or deleted since
+  they were written last. Whether a key is to be written or deleted is decided when
+  the journal is applied, by looking it up. When the journal can not tell what has
+  changed, every key is taken as changed.
+*/
+typedef struct c_log_s
+{
+    str_t *__key; /*!< copies of the changed keys, a key may appear more than once */
+    size_t __num; /*!< number of keys */
+    size_t __mem; /*!< memory of keys */
+    int __all; /*!< every key may have changed, no key is kept */
+} c_log_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+static inline size_t c_log_num(const c_log_s *ctx) { return ctx->__num; }
+
+static inline cstr_t c_log_key(const c_log_s *ctx, size_t idx) { return ctx->__key[idx]; }
+
+static inline int c_log_is_all(const c_log_s *ctx) { return ctx->__all; }
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+void c_log_ctor(c_log_s *ctx);
+
+void c_log_dtor(c_log_s *ctx);
+
+/*!
+ @brief record that the entry of key has changed.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory, every key is taken as changed
+*/
+int c_log_put(c_log_s *ctx, cstr_t key);
+
+/*!
+ @brief take every key as changed and release the recorded ones.
+*/
+void c_log_all(c_log_s *ctx);
+
+/*!
+ @brief forget the changes after they are written, the memory is kept.
+*/
+void c_log_drop(c_log_s *ctx);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif /* __cplusplus */
+
+/*! @} LOG */
+
+#endif /* __C_LOG_H__ */
@@ -71,6 +71,8 @@ enum
     SUCCESS,
     FAILURE,
     INVALID,
+    OVERFLOW,
+    NOTFOUND,
 };
 
 #endif /* __A_OUTPUT_H__ */
@@ -100,6 +100,25 @@ rule_s *c_rule_pop_fore(c_rule_s *ctx);
 
 rule_s *c_rule_pop_back(c_rule_s *ctx);
 
+/*!
+ @brief reserve memory for num entries at once, the memory is not grown geometrically.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_rule_reserve(c_rule_s *ctx, size_t num);
+
+/*!
+ @brief push n constructed entries at once.
+ @return a pointer to the first of them, or NULL when out of memory.
+*/
+rule_s *c_rule_append_n(c_rule_s *ctx, size_t n);
+
+/*!
+ @brief release the memory beyond the entries.
+*/
+int c_rule_shrink_to_fit(c_rule_s *ctx);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -21,6 +21,9 @@
 
 /*!
  @brief instance structure for basic string
+ @details a short string is stored inside the structure itself, its bytes
+  overlay the fields and the last byte is 0x80 | length. The string does
+  not point into the structure, so the structure can be moved by memcpy.
 */
 typedef struct str_s
 {
@@ -29,6 +32,28 @@ typedef struct str_s
     size_t __mem; /*!< memory */
 } str_s;
 
+#ifndef STR_SSO
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+/* the last byte is a byte of __mem that is not always zero */
+#define STR_SSO 0
+#else /* !__BYTE_ORDER__ */
+/*!
+ memory of a string stored inside the structure
+*/
+#define STR_SSO (sizeof(str_s) - 1)
+#endif /* __BYTE_ORDER__ */
+#endif /* STR_SSO */
+
+/*!
+ @brief check whether the string is stored inside the structure
+ @param[in] ctx points to an instance of string structure
+ @return true if the string is short
+*/
+static inline int str_sso(const str_s *ctx)
+{
+    return STR_SSO && (((const unsigned char *)ctx)[sizeof(str_s) - 1] & 0x80);
+}
+
 #ifndef STR_NIL
 // clang-format off
 #define STR_NIL {NULL, 0, 0}
@@ -40,21 +65,30 @@ typedef struct str_s
  @param[in] ctx points to an instance of string structure
  @return string
 */
-static inline char *str_val(const str_s *ctx) { return ctx->__str; }
+static inline char *str_val(const str_s *ctx)
+{
+    return str_sso(ctx) ? (char *)(uintptr_t)ctx : ctx->__str;
+}
 
 /*!
  @brief length for a pointer to string structure
  @param[in] ctx points to an instance of string structure
  @return size of length
 */
-static inline size_t str_len(const str_s *ctx) { return ctx->__num; }
+static inline size_t str_len(const str_s *ctx)
+{
+    return str_sso(ctx) ? ((const unsigned char *)ctx)[sizeof(str_s) - 1] & 0x7Fu : ctx->__num;
+}
 
 /*!
  @brief memory for a pointer to string structure
  @param[in] ctx points to an instance of string structure
  @return size of memory
 */
-static inline size_t str_mem(const str_s *ctx) { return ctx->__mem; }
+static inline size_t str_mem(const str_s *ctx)
+{
+    return str_sso(ctx) ? STR_SSO : ctx->__mem;
+}
 
 #if defined(__cplusplus)
 extern "C" {
@@ -114,7 +148,7 @@ str_s *str_move(str_s *ctx, str_s *obj);
 /*!
  @brief terminate a pointer to string structure
  @param[in] ctx points to an instance of string structure
- @return string of string structure
+ @return string of string structure, a short string is copied to the heap
  @note need to use free to release this memory
 */
 char *str_exit(str_s *ctx);
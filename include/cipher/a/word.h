@@ -8,6 +8,8 @@
 #define __C_WORD_H__
 
 #include "output.h"
+#include "index.h"
+#include "log.h"
 #include "str.h"
 
 #define c_word_forenum(i, ctx) for (size_t i = 0; i != CAST(size_t, (ctx)->tail - (ctx)->head); ++i)
@@ -26,6 +28,8 @@ typedef struct c_word_s
     str_s *head;
     str_s *tail;
     str_s *last;
+    c_index_s __index[1]; /*!< index by word and by trigram, slot map over the entries */
+    c_log_s __log[1];     /*!< the words changed by c_word_add, c_word_del and c_word_erase */
 } c_word_s;
 
 static inline str_s *c_word_ptr(const c_word_s *ctx) { return ctx->head; }
@@ -52,6 +56,8 @@ static inline str_s *c_word_top(const c_word_s *ctx)
     return ctx->head != ctx->tail ? ctx->tail - 1 : NULL;
 }
 
+static inline c_log_s *c_word_log(c_word_s *ctx) { return ctx->__log; }
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* __cplusplus */
@@ -84,6 +90,102 @@ str_s *c_word_pop_fore(c_word_s *ctx);
 
 str_s *c_word_pop_back(c_word_s *ctx);
 
+/*!
+ @brief find the first entry that holds text through the index.
+ @note an indexed entry must only change through c_word_forget first,
+  or call c_word_reindex after changing it.
+*/
+str_s *c_word_find(c_word_s *ctx, cstr_t text);
+
+/*!
+ @brief remove an entry from the index before it changes.
+*/
+void c_word_forget(c_word_s *ctx, const str_s *obj);
+
+/*!
+ @brief rebuild the index from all entries.
+*/
+int c_word_reindex(c_word_s *ctx);
+
+/*!
+ @brief add an entry to the index after it is set, the counterpart of c_word_forget.
+*/
+int c_word_remember(c_word_s *ctx, const str_s *obj);
+
+/*!
+ @brief get a free slot, the last freed one is reused before the vector grows.
+ @return a constructed entry without word, or NULL when out of memory.
+ @note set the word and call c_word_remember, a reused slot is not indexed on demand.
+*/
+str_s *c_word_claim(c_word_s *ctx);
+
+/*!
+ @brief give back a slot of c_word_claim that could not be set, it is freed without a change.
+ @note the entry is forgotten and destructed first, the journal is left as it was.
+*/
+void c_word_unclaim(c_word_s *ctx, str_s *obj);
+
+/*!
+ @brief destruct the entry at idx and free its slot, the later entries keep their positions.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 idx is out of range or the slot is already free
+*/
+int c_word_erase(c_word_s *ctx, size_t idx);
+
+/*!
+ @brief get the handle of the entry at idx, it is valid until the entry leaves its slot.
+*/
+u64_t c_word_id(const c_word_s *ctx, size_t idx);
+
+/*!
+ @brief get the entry of a handle.
+ @return NULL when the entry has been erased, moved or popped since the handle was taken.
+*/
+str_s *c_word_get(const c_word_s *ctx, u64_t id);
+
+/*!
+ @brief move the entries over the free slots, keeping their order.
+ @return number of slots reclaimed.
+ @note the handles of the entries after the first free slot are invalidated.
+*/
+size_t c_word_compact(c_word_s *ctx);
+
+/*!
+ @brief reserve memory for num entries at once, the memory is not grown geometrically.
+ @return the execution state of the function
+  @retval 0 success
+  @retval 1 out of memory
+*/
+int c_word_reserve(c_word_s *ctx, size_t num);
+
+/*!
+ @brief push n constructed entries at once.
+ @return a pointer to the first of them, or NULL when out of memory.
+*/
+str_s *c_word_append_n(c_word_s *ctx, size_t n);
+
+/*!
+ @brief release the memory beyond the entries.
+ @note the generations of the released slots are forgotten, so are the handles of popped entries.
+*/
+int c_word_shrink_to_fit(c_word_s *ctx);
+
+/*!
+ @brief find the first entry from idx on whose word contains str.
+ @details the words are looked up in a trigram index that is built by the first search,
+  an entry that is added or erased later is indexed by the next one.
+  The word of an indexed entry must only change through c_word_forget first.
+ @return the position of the entry, or the number of entries when there is none.
+*/
+size_t c_word_search(c_word_s *ctx, cstr_t str, size_t idx);
+
+/*!
+ @brief record in the journal that the entry of word has changed.
+ @details once half of the entries have changed, they are all taken as changed.
+*/
+void c_word_mark(c_word_s *ctx, cstr_t word);
+
 #if defined(__cplusplus)
 } /* extern "C" */
 #endif /* __cplusplus */
@@ -7,10 +7,13 @@
 #ifndef __CIPHER_CIPHER_H__
 #define __CIPHER_CIPHER_H__
 
+#include "a/arena.h"
 #include "a/output.h"
 
 #include <stdlib.h>
 
+struct hash_s;
+
 #define CIPHER_OUTSIZ 0x80
 
 typedef enum cipher_e
@@ -21,16 +24,26 @@ typedef enum cipher_e
     CIPHER_TOTAL,
 } cipher_e;
 
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
 typedef struct cipher_s
 {
     str_t text;
-    str_t hash;
+    str_t hash; /*!< an interned name when set through cipher_set_hash */
     str_t hint;
     str_t misc;
     uint_t type;
     uint_t size;
+    uint_t __ref; /*!< the fields that live in an arena, they are copied on write and never freed */
 } cipher_s;
 
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
 #define cipher_get_text(ctx) (ctx)->text
 #define cipher_get_hash(ctx) (ctx)->hash
 #define cipher_get_hint(ctx) (ctx)->hint
@@ -55,11 +68,81 @@ int cipher_set_hash(cipher_s *ctx, cptr_t hash);
 void cipher_set_type(cipher_s *ctx, uint_t type);
 void cipher_set_size(cipher_s *ctx, uint_t size);
 
+/*!
+ @brief set a field to a copy in arena, the copy is released with the arena.
+ @note When arena is 0, it is the same as cipher_set_*.
+ @note A known hash name is interned and never copied,
+  an unknown one is copied and the setter returns nonzero.
+*/
+int cipher_put_hint(cipher_s *ctx, c_arena_s *arena, cptr_t hint);
+int cipher_put_misc(cipher_s *ctx, c_arena_s *arena, cptr_t misc);
+int cipher_put_text(cipher_s *ctx, c_arena_s *arena, cptr_t text);
+int cipher_put_hash(cipher_s *ctx, c_arena_s *arena, cptr_t hash);
+
+/*!
+ @brief resolve a hash algorithm name, it ignores case and accepts aliases such as SHA-256.
+ @param[in] name the name of a hash algorithm
+ @return the hash descriptor, or 0 when the name is unknown
+*/
+const struct hash_s *cipher_hash(cstr_t name);
+
+/*!
+ @brief get the id of a hash algorithm name, the index of its interned name.
+ @param[in] name the name of a hash algorithm
+ @return the id, or -1 when the name is unknown
+*/
+int cipher_hash_id(cstr_t name);
+
+/*!
+ @brief get the interned name of a hash id.
+ @return the name, or 0 when the id is out of range
+*/
+cstr_t cipher_hash_name(unsigned int id);
+
 int cipher_copy(cipher_s *ctx, const cipher_s *obj);
+/*!
+ @brief copy obj with its fields in arena, like cipher_copy when arena is 0.
+*/
+int cipher_put(cipher_s *ctx, c_arena_s *arena, const cipher_s *obj);
 cipher_s *cipher_move(cipher_s *ctx, cipher_s *obj);
 
+/*!
+ @brief set the four rules of cipher_v2, the strings are not copied.
+ @details the HMAC key states of the rules are derived under every hash at once, so that
+  cipher_v2 only reads them and may run on many threads. It and cipher_v2_import must not
+  run along with cipher_v2. Before the rules are set, cipher_v2 derives the states each time.
+*/
 void cipher_v2_init(cptr_t s0, cptr_t s1, cptr_t s2, cptr_t s3);
 
+/*!
+ @brief set the four rules of cipher_v2 as cipher_v2_init does, without their HMAC key states.
+ @details the states under a hash are then imported by cipher_v2_import, cipher_v2 derives
+  them each time under a hash without them.
+*/
+void cipher_v2_rule(cptr_t s0, cptr_t s1, cptr_t s2, cptr_t s3);
+
+/*!
+ @brief export the HMAC key states of the rules under hash.
+ @param[in] hash the name of a hash algorithm, 0 for MD5
+ @param[out] out where to store the blob
+ @param[in,out] siz max size and resulting size of the blob
+ @return the execution state of the function
+  @retval SUCCESS success
+  @retval OVERFLOW the buffer is too small, siz holds the needed size
+  @retval NOTFOUND the hash is unknown
+*/
+int cipher_v2_export(cstr_t hash, void *out, size_t *siz);
+
+/*!
+ @brief import the HMAC key states of the rules under hash, as exported by cipher_v2_export.
+ @details the blob must belong to the rules set by cipher_v2_init, which is not checked.
+ @return the execution state of the function
+  @retval SUCCESS success
+  @retval INVALID the blob is malformed, of another version or of another hash
+  @retval NOTFOUND the hash is unknown
+*/
+int cipher_v2_import(cstr_t hash, const void *pdata, size_t nbyte);
+
 int cipher_v1(const cipher_s *ctx, cstr_t word, str_t *out);
 int cipher_v2(const cipher_s *ctx, cstr_t word, str_t *out);
 
@@ -19,31 +19,309 @@
 #endif /* __GNUC__ || __clang__ */
 
 #include "info.h"
+#include "rule.h"
 #include "word.h"
 
+/*!
+ @brief the statements kept by a handle, each one is prepared when it is first used
+*/
+typedef enum c_sqlite_e
+{
+    C_SQLITE_BEGIN,
+    C_SQLITE_COMMIT,
+    C_SQLITE_ABORT,
+    C_SQLITE_SAVE,
+    C_SQLITE_RELEASE,
+    C_SQLITE_ROLLBACK,
+    C_SQLITE_CREATE_RULE,
+    C_SQLITE_CREATE_KEY,
+    C_SQLITE_CREATE_WORD,
+    C_SQLITE_CREATE_INFO,
+    C_SQLITE_DELETE_RULE,
+    C_SQLITE_DELETE_KEY,
+    C_SQLITE_DELETE_WORD,
+    C_SQLITE_DELETE_INFO,
+    C_SQLITE_COUNT_WORD,
+    C_SQLITE_COUNT_INFO,
+    C_SQLITE_OUT_RULE,
+    C_SQLITE_OUT_WORD,
+    C_SQLITE_OUT_INFO,
+    C_SQLITE_ADD_RULE,
+    C_SQLITE_ADD_WORD,
+    C_SQLITE_ADD_INFO,
+    C_SQLITE_DEL_RULE,
+    C_SQLITE_DEL_WORD,
+    C_SQLITE_DEL_INFO,
+    C_SQLITE_PUT_WORD,
+    C_SQLITE_PUT_INFO,
+    C_SQLITE_GET_INFO,
+    C_SQLITE_PAGE_INFO,
+    C_SQLITE_RANK_INFO,
+    C_SQLITE_WALK_INFO,
+    C_SQLITE_PREFIX_INFO,
+    C_SQLITE_MATCH_INFO,
+    C_SQLITE_SCAN_INFO,
+    C_SQLITE_GET_KEY,
+    C_SQLITE_PUT_KEY,
+    C_SQLITE_LOAD_WORD,
+    C_SQLITE_LOAD_INFO,
+    C_SQLITE_TOTAL,
+} c_sqlite_e;
+
+/*!
+ @brief instance structure for sqlite handle
+ @details it wraps a connection, which is either passed to c_sqlite_ctor and left to the
+  caller, or opened by c_sqlite_open and closed by c_sqlite_close. The statements are compiled once
+  and kept until the handle is destroyed, a reused statement is reset and its bindings
+  are cleared. A statement that fails to compile is not kept, the call returns the
+  error and the next call compiles it again. A table that is dropped and created again
+  makes sqlite compile the statements that use it on their next step.
+*/
+typedef struct c_sqlite_s
+{
+    sqlite3 *db;
+    sqlite3_stmt *__stmt[C_SQLITE_TOTAL]; /*!< 0 until the statement is first used */
+} c_sqlite_s;
+
+/*!
+ @brief the settings a connection is opened with by c_sqlite_open
+*/
+typedef enum c_sqlite_profile_e
+{
+    /*! one process reads and writes a few rows at a time, others may read meanwhile */
+    C_SQLITE_INTERACTIVE,
+    /*! one process writes many rows, the file is rebuilt if the process dies */
+    C_SQLITE_BULK_IMPORT,
+    /*! the file is only read, through memory mapped pages */
+    C_SQLITE_READ_ONLY_MMAP,
+    C_SQLITE_PROFILE,
+} c_sqlite_profile_e;
+
+/*!
+ @brief the function that takes each entry found by a search
+ @param[in] arg the argument passed to the search
+ @param[in] idx the position of the entry in the order of text, as in c_sqlite_page_info
+ @param[in] it the entry, it is only valid during the call
+ @return 0 to go on, or the search stops
+*/
+typedef int (*c_sqlite_info_f)(void *arg, size_t idx, const cipher_s *it);
+
+/*!
+ @brief the function that takes the result of each chunk of a bulk load
+ @param[in] arg the argument passed to the load
+ @param[in] idx the position in the input of the first entry of the chunk
+ @param[in] num the number of entries of the chunk
+ @param[in] ok the result code of sqlite for the chunk, a failed chunk writes nothing
+ @return 0 to go on, or the load stops
+*/
+typedef int (*c_sqlite_chunk_f)(void *arg, size_t idx, size_t num, int ok);
+
+/*!
+ @brief the function that takes the progress of a backup after each step
+ @param[in] arg the argument passed to the backup
+ @param[in] remaining the number of pages that are left to be copied
+ @param[in] pagecount the number of pages of the source
+ @return 0 to go on, or the backup stops
+*/
+typedef int (*c_sqlite_backup_f)(void *arg, int remaining, int pagecount);
+
+static inline sqlite3 *c_sqlite_db(const c_sqlite_s *ctx) { return ctx->db; }
+
 #if defined(__cplusplus)
 extern "C" {
 #endif /* __cplusplus */
 
-int c_sqlite_init(sqlite3 *db);
-int c_sqlite_exit(sqlite3 *db);
-
-int c_sqlite_begin(sqlite3 *db);
-int c_sqlite_commit(sqlite3 *db);
-
-int c_sqlite_create_rule(sqlite3 *db);
-int c_sqlite_create_word(sqlite3 *db);
-int c_sqlite_create_info(sqlite3 *db);
-int c_sqlite_delete_rule(sqlite3 *db);
-int c_sqlite_delete_word(sqlite3 *db);
-int c_sqlite_delete_info(sqlite3 *db);
-
-int c_sqlite_out_word(sqlite3 *db, c_word_s *out);
-int c_sqlite_out_info(sqlite3 *db, c_info_s *out);
-int c_sqlite_add_word(sqlite3 *db, const c_word_s *in);
-int c_sqlite_add_info(sqlite3 *db, const c_info_s *in);
-int c_sqlite_del_word(sqlite3 *db, const c_word_s *in);
-int c_sqlite_del_info(sqlite3 *db, const c_info_s *in);
+void c_sqlite_ctor(c_sqlite_s *ctx, sqlite3 *db);
+
+/*!
+ @brief open the database at path with the settings of profile.
+ @details the profile sets journal_mode, synchronous, mmap_size, cache_size, temp_store
+  and locking_mode. C_SQLITE_INTERACTIVE also waits up to 5 seconds for a lock held by
+  another connection before it returns SQLITE_BUSY. The connection is opened without its mutex, so it must be used by
+  one thread at a time. When the database can not be opened, the connection is kept for
+  sqlite3_errmsg and must still be closed.
+ @return the result code of sqlite
+*/
+int c_sqlite_open(c_sqlite_s *ctx, cstr_t path, c_sqlite_profile_e profile);
+
+/*!
+ @brief finalize the statements of the handle and close its connection.
+ @return the result code of sqlite3_close
+*/
+int c_sqlite_close(c_sqlite_s *ctx);
+
+/*!
+ @brief copy the database to path as a snapshot, pages at a time, the file at path is replaced.
+ @details the source is only locked while a step copies its pages, so it may be written
+  between the steps. A write through another connection makes the copy start over, one
+  through this connection is committed by then and is copied along. The connection must
+  not be in a transaction, and a lock held by another one is waited on for 5 seconds at most.
+  The file is copied as it is, free pages included.
+ @param[in] pages the number of pages of a step, 0 for all of them at once
+ @param[in] func the function that takes the progress after each step, it may be 0
+ @return the result code of sqlite
+  @retval SQLITE_OK the copy is complete
+  @retval SQLITE_ABORT func stopped the backup
+  @retval SQLITE_LOCKED the connection is in a transaction
+  @retval SQLITE_BUSY another connection held its lock for too long
+*/
+int c_sqlite_backup(c_sqlite_s *ctx, cstr_t path, int pages, c_sqlite_backup_f func, void *arg);
+
+/*!
+ @brief write a compacted copy of the database to path with VACUUM INTO.
+ @details the copy has no free pages and its tables and indexes are packed, but it is
+  written by one statement. The file at path must not exist or be empty, and the
+  connection must not be in a transaction.
+ @return the result code of sqlite
+*/
+int c_sqlite_vacuum(c_sqlite_s *ctx, cstr_t path);
+
+/*!
+ @brief finalize the statements of the handle, the connection is left open.
+*/
+void c_sqlite_dtor(c_sqlite_s *ctx);
+
+int c_sqlite_init(c_sqlite_s *ctx);
+int c_sqlite_exit(c_sqlite_s *ctx);
+
+/*!
+ @brief check whether the tables of words and entries are there, as c_sqlite_init leaves them.
+ @details a database that has them can be read through a connection of C_SQLITE_READ_ONLY_MMAP.
+ @return 1 when both tables are there, otherwise 0
+*/
+int c_sqlite_has_init(c_sqlite_s *ctx);
+
+int c_sqlite_begin(c_sqlite_s *ctx);
+int c_sqlite_commit(c_sqlite_s *ctx);
+int c_sqlite_rollback(c_sqlite_s *ctx);
+
+/*!
+ @brief create or drop the table of rules, along with the cache of their key states.
+*/
+int c_sqlite_create_rule(c_sqlite_s *ctx);
+int c_sqlite_create_word(c_sqlite_s *ctx);
+int c_sqlite_create_info(c_sqlite_s *ctx);
+int c_sqlite_delete_rule(c_sqlite_s *ctx);
+int c_sqlite_delete_word(c_sqlite_s *ctx);
+int c_sqlite_delete_info(c_sqlite_s *ctx);
+
+/*!
+ @brief load, add or delete the rules, a rule that is already there is not added again.
+ @details an empty string of a rule is stored as null.
+*/
+int c_sqlite_out_rule(c_sqlite_s *ctx, c_rule_s *out);
+int c_sqlite_add_rule(c_sqlite_s *ctx, const c_rule_s *in);
+int c_sqlite_del_rule(c_sqlite_s *ctx, const c_rule_s *in);
+
+int c_sqlite_out_word(c_sqlite_s *ctx, c_word_s *out);
+int c_sqlite_out_info(c_sqlite_s *ctx, c_info_s *out);
+int c_sqlite_add_word(c_sqlite_s *ctx, const c_word_s *in);
+int c_sqlite_add_info(c_sqlite_s *ctx, const c_info_s *in);
+int c_sqlite_del_word(c_sqlite_s *ctx, const c_word_s *in);
+int c_sqlite_del_info(c_sqlite_s *ctx, const c_info_s *in);
+
+/*!
+ @brief set rule as the rules of cipher_v2, with its HMAC key states under hash from the cache.
+ @details the states are looked up by a digest of the four strings of rule, so those of a
+  rule that has changed are never used. When they are not cached, they are derived once
+  and stored. The strings of rule must outlive its use by cipher_v2.
+ @param[in] hash the name of a hash algorithm, 0 for MD5
+ @return the result code of sqlite
+  @retval SQLITE_OK the key states are ready
+  @retval SQLITE_NOTFOUND the hash is unknown
+*/
+int c_sqlite_key_rule(c_sqlite_s *ctx, const rule_s *rule, cstr_t hash);
+
+/*!
+ @brief the number of words or entries in the table, a row without text is not counted.
+*/
+size_t c_sqlite_count_word(c_sqlite_s *ctx);
+size_t c_sqlite_count_info(c_sqlite_s *ctx);
+
+/*!
+ @brief look up the entry of text in the table.
+ @param[out] out the fields of the entry, it is left as it is when there is none
+ @return the result code of sqlite
+  @retval SQLITE_OK the entry is found
+  @retval SQLITE_NOTFOUND there is no entry of text
+*/
+int c_sqlite_get_info(c_sqlite_s *ctx, cstr_t text, cipher_s *out);
+
+/*!
+ @brief append at most num entries to out, from position idx in the order of their text.
+ @details the positions are the same as those of the entries loaded by c_sqlite_out_info.
+ @return the result code of sqlite
+*/
+int c_sqlite_page_info(c_sqlite_s *ctx, size_t idx, size_t num, c_info_s *out);
+
+/*!
+ @brief insert the word, a word that is there is left as it is.
+ @return the result code of sqlite
+*/
+int c_sqlite_put_word(c_sqlite_s *ctx, cstr_t text);
+
+/*!
+ @brief delete the word from the table.
+ @return the result code of sqlite
+  @retval SQLITE_OK the word is deleted
+  @retval SQLITE_NOTFOUND there is no such word
+*/
+int c_sqlite_remove_word(c_sqlite_s *ctx, cstr_t text);
+
+/*!
+ @brief insert the entry, or update the entry of the same text.
+ @return the result code of sqlite
+*/
+int c_sqlite_put_info(c_sqlite_s *ctx, const cipher_s *in);
+
+/*!
+ @brief delete the entry of text from the table.
+ @return the result code of sqlite
+  @retval SQLITE_OK the entry is deleted
+  @retval SQLITE_NOTFOUND there is no entry of text
+*/
+int c_sqlite_remove_info(c_sqlite_s *ctx, cstr_t text);
+
+/*!
+ @brief pass every entry whose text starts with str to func, in the order of text.
+ @details the entries are read from the primary key of text as a range.
+ @return the result code of sqlite
+*/
+int c_sqlite_prefix_info(c_sqlite_s *ctx, cstr_t str, c_sqlite_info_f func, void *arg);
+
+/*!
+ @brief pass every entry whose text contains str to func, in the order of text.
+ @details the hints are not searched, as c_info_search does not search them either.
+  A str of three characters of UTF-8 or more is looked up in the full text index of info,
+  which c_sqlite_create_info creates when sqlite has the fts5 module. Otherwise the
+  table is scanned.
+ @return the result code of sqlite
+*/
+int c_sqlite_match_info(c_sqlite_s *ctx, cstr_t str, c_sqlite_info_f func, void *arg);
+
+/*!
+ @brief insert the words or entries chunk by chunk, the entry of a text that is there is updated.
+ @details a chunk is committed on its own, or released as a savepoint inside a transaction.
+  Its rows are inserted as many at a time as the parameters of a statement allow. When the
+  entries are many against those in the table, the full text index is dropped first and
+  built again at the end.
+ @param[in] chunk the number of entries of a chunk, 0 for all of them
+ @param[in] func the function that takes the result of each chunk, it may be 0
+ @return the result code of sqlite of the first failed chunk
+*/
+int c_sqlite_load_word(c_sqlite_s *ctx, const c_word_s *in, size_t chunk, c_sqlite_chunk_f func, void *arg);
+int c_sqlite_load_info(c_sqlite_s *ctx, const c_info_s *in, size_t chunk, c_sqlite_chunk_f func, void *arg);
+
+/*!
+ @brief write the changes recorded in the journals of word and info, then clear them.
+ @details every changed key that is still present is inserted or updated, the others
+  are deleted, in one transaction. A journal that has lost track of its changes writes
+  the whole table again. Either word or info may be 0. On the first failed statement,
+  the transaction is rolled back and both journals are kept, so the changes can be
+  written again. Within a transaction of the caller, rolling back is left to it.
+ @return the result code of sqlite of the first failed statement
+*/
+int c_sqlite_apply_changes(c_sqlite_s *ctx, c_word_s *word, c_info_s *info);
 
 #if defined(__cplusplus)
 }
@@ -0,0 +1,98 @@
+/*!
+ @file writer.h
+ @brief cipher background writer
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __CIPHER_WRITER_H__
+#define __CIPHER_WRITER_H__
+
+#include "sqlite.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ @brief instance structure for background writer
+ @details it owns a connection to a database and writes the changes that are queued
+  to it from a thread of its own. Any thread may queue a change, without a lock. The
+  changes are written as one transaction when batch of them are queued, or msec after
+  the first of them, or when c_writer_flush is called. A change that is followed by
+  another one of the same key in a batch is never written. A batch that fails on a
+  lock is rolled back and written again along with the next one, a batch that fails
+  otherwise is rolled back and given up. Without threads, a batch is written by the
+  call that fills it and there is no timer.
+*/
+typedef struct c_writer_s
+{
+    c_sqlite_s __sql[1]; /*!< used by the thread of the writer alone */
+    struct c_writer_node_s *__head; /*!< the changes queued last first */
+    struct c_writer_node_s *__retry; /*!< the changes of a batch that failed on a lock, oldest first */
+    void *__sync; /*!< the thread of the writer and what it waits on */
+    size_t __num; /*!< number of changes queued */
+    size_t __batch; /*!< number of changes that are written at once */
+    unsigned int __msec; /*!< the longest a change waits to be written */
+    int __ok; /*!< the first error since the last flush */
+    int __stop; /*!< the thread is to write what is left and return */
+} c_writer_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief open the database at path for the writer and start its thread.
+ @details the database is opened as C_SQLITE_INTERACTIVE, so it may be read meanwhile.
+  When it fails, nothing is left to be closed.
+ @param[in] batch the number of changes that are written at once, 0 for one
+ @param[in] msec the longest a change waits to be written
+ @return the result code of sqlite
+*/
+int c_writer_open(c_writer_s *ctx, cstr_t path, size_t batch, unsigned int msec);
+
+/*!
+ @brief write the changes that are left, stop the thread and close the database.
+ @details the changes that fail to be written now are given up.
+ @return the result code of sqlite of the first error since the last flush
+*/
+int c_writer_close(c_writer_s *ctx);
+
+/*!
+ @brief queue a word or an entry to be inserted, or its key to be deleted.
+ @details the word or the entry is copied.
+ @return the result code of sqlite
+  @retval SQLITE_OK the change is queued
+  @retval SQLITE_NOMEM out of memory
+*/
+int c_writer_put_word(c_writer_s *ctx, cstr_t text);
+int c_writer_del_word(c_writer_s *ctx, cstr_t text);
+int c_writer_put_info(c_writer_s *ctx, const cipher_s *in);
+int c_writer_del_info(c_writer_s *ctx, cstr_t text);
+
+/*!
+ @brief queue the changes recorded in the journals of word and info, then clear them.
+ @details as c_sqlite_apply_changes does, either word or info may be 0.
+ @return the result code of sqlite
+  @retval SQLITE_OK the changes are queued
+  @retval SQLITE_NOMEM out of memory, the journals are kept
+*/
+int c_writer_apply(c_writer_s *ctx, c_word_s *word, c_info_s *info);
+
+/*!
+ @brief wait until every change queued before the call is written or has failed.
+ @return the result code of sqlite of the first error since the last flush
+  @retval SQLITE_BUSY a lock was held, the changes are written again with the next batch
+*/
+int c_writer_flush(c_writer_s *ctx);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __CIPHER_WRITER_H__ */
@@ -0,0 +1,107 @@
+/*!
+ @file pbkdf2.h
+ @brief RFC 8018 compliant PBKDF2 implementation
+ @details https://www.ietf.org/rfc/rfc8018.txt
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __CKSUM_PBKDF2_H__
+#define __CKSUM_PBKDF2_H__
+
+#include "hmac.h"
+
+/*!
+ number of output blocks or passwords that are iterated together
+*/
+#define PBKDF2_LANES 4
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*!
+ the HMAC key state of a password, the ipad and opad blocks are already hashed
+*/
+typedef struct pbkdf2_s
+{
+    hash_u __inner[1];
+    hash_u __outer[1];
+    const hash_s *__hash;
+} pbkdf2_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Initialize function for PBKDF2, hash the ipad and opad blocks of a password once.
+ @param[in,out] ctx points to an instance of PBKDF2.
+ @param[in] hash points to an instance of hash descriptor.
+ @param[in] pdata points to password.
+ @param[in] nbyte length of password.
+ @return the execution state of the function
+  @retval 0 success
+*/
+int pbkdf2_init(pbkdf2_s *ctx, const hash_s *hash, const void *pdata, size_t nbyte);
+
+/*!
+ @brief Derive a key from an initialized password, it can be called many times.
+ @param[in] ctx points to an instance of PBKDF2.
+ @param[in] psalt points to salt.
+ @param[in] nsalt length of salt.
+ @param[in] iter iteration count.
+ @param[out] out points to buffer that holds the derived key.
+ @param[in] siz length of the derived key.
+ @return the execution state of the function
+  @retval 0 success
+  @retval -3 iter is 0
+  @retval -4 siz is too large
+*/
+int pbkdf2_done(const pbkdf2_s *ctx, const void *psalt, size_t nsalt, size_t iter, void *out, size_t siz);
+
+/*!
+ @brief Derive a key from a password.
+ @param[in] hash points to an instance of hash descriptor.
+ @param[in] pkey points to password.
+ @param[in] nkey length of password.
+ @param[in] psalt points to salt.
+ @param[in] nsalt length of salt.
+ @param[in] iter iteration count.
+ @param[out] out points to buffer that holds the derived key.
+ @param[in] siz length of the derived key.
+ @return the execution state of the function
+  @retval 0 success
+  @retval -3 iter is 0
+  @retval -4 siz is too large
+*/
+int pbkdf2(const hash_s *hash, const void *pkey, size_t nkey, const void *psalt, size_t nsalt, size_t iter, void *out, size_t siz);
+
+/*!
+ @brief Derive keys from several passwords that share a salt and an iteration count.
+ @param[in] hash points to an instance of hash descriptor.
+ @param[in] pkey points to count passwords.
+ @param[in] nkey points to count lengths of passwords.
+ @param[in] count number of passwords.
+ @param[in] psalt points to salt.
+ @param[in] nsalt length of salt.
+ @param[in] iter iteration count.
+ @param[out] out points to buffer that holds count derived keys back to back.
+ @param[in] siz length of every derived key.
+ @return the execution state of the function
+  @retval 0 success
+  @retval -3 iter is 0
+  @retval -4 siz is too large
+*/
+int pbkdf2_multi(const hash_s *hash, const void *const *pkey, const size_t *nkey, size_t count,
+                 const void *psalt, size_t nsalt, size_t iter, void *out, size_t siz);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __CKSUM_PBKDF2_H__ */
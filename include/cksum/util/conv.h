@@ -58,6 +58,55 @@ void *digest(const void *pdata, size_t nbyte, unsigned int cases, void *out);
 void *digest_lower(const void *pdata, size_t nbyte, void *out);
 void *digest_upper(const void *pdata, size_t nbyte, void *out);
 
+/*!
+ @brief convert an array of digests to strings.
+ @param[in] pdata points to count digests of nbyte each, stored back to back.
+ @param[in] nbyte length of every digest.
+ @param[in] count number of digests.
+ @param[in] cases select the converted case.
+  @arg 0 lower
+  @arg 1 upper
+ @param[in,out] out points to buffer that holds the strings,
+  the string of digest i starts at out + i * (nbyte * 2 + 1).
+ @return a pointer to the strings.
+ @note When out is 0, you need to use free to release the memory.
+*/
+void *digests(const void *pdata, size_t nbyte, size_t count, unsigned int cases, void *out);
+
+/*!
+ @brief encode data to hexadecimal, no null is appended.
+ @param[in] pdata points to data to encode.
+ @param[in] nbyte length of data to encode.
+ @param[in] cases select the encoded case.
+  @arg 0 lower
+  @arg 1 upper
+ @param[out] out points to buffer of at least nbyte * 2 bytes.
+ @return a pointer past the last character written.
+*/
+char *hex_encode(const void *pdata, size_t nbyte, unsigned int cases, void *out);
+
+/*!
+ @brief decode hexadecimal to data.
+ @param[in] pdata points to hexadecimal to decode.
+ @param[in] nbyte length of hexadecimal, it must be even.
+ @param[out] out points to buffer of at least nbyte / 2 bytes.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -1 nbyte is odd or a character is not hexadecimal
+*/
+int hex_decode(const void *pdata, size_t nbyte, void *out);
+
+/*!
+ @brief convert every hexadecimal character to its value, like xdigit.
+ @param[in] pdata points to hexadecimal to convert.
+ @param[in] nbyte length of hexadecimal.
+ @param[out] out points to buffer of at least nbyte bytes, each holds 0 ~ 15.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -1 a character is not hexadecimal
+*/
+int hex_xdigits(const void *pdata, size_t nbyte, void *out);
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
@@ -62,6 +62,12 @@ int hash_filehandle(const hash_s *ctx, FILE *in, void *out, size_t *siz);
 */
 int hash_file(const hash_s *ctx, const char *fname, void *out, size_t *siz);
 
+/*!
+ @brief Release what hash_file and hmac_file keep to read files in the calling thread.
+ @details a thread that read files calls it before it exits, a later read sets it up again.
+*/
+void hash_file_release(void);
+
 #if defined(__cplusplus)
 }
 #endif /* __cplusplus */
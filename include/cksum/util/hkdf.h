@@ -0,0 +1,78 @@
+/*!
+ @file hkdf.h
+ @brief RFC 5869 compliant HKDF implementation
+ @details https://www.ietf.org/rfc/rfc5869.txt
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __CKSUM_UTIL_HKDF_H__
+#define __CKSUM_UTIL_HKDF_H__
+
+#include "../hmac.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Extract a pseudorandom key from input keying material.
+ @param[in] hash points to an instance of hash.
+ @param[in] psalt points to salt, a string of hash->outsiz zeros when nsalt is 0.
+ @param[in] nsalt length of salt.
+ @param[in] pikm points to input keying material.
+ @param[in] nikm length of input keying material.
+ @param[out] out where to store the pseudorandom key.
+ @param[in,out] siz max size and resulting size of the pseudorandom key.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -4 the buffer is too small, siz holds the needed size
+*/
+int hkdf_extract(const hash_s *hash, const void *psalt, size_t nsalt, const void *pikm, size_t nikm, void *out, size_t *siz);
+
+/*!
+ @brief Prepare the key state of a pseudorandom key, it can be expanded many times.
+ @param[in,out] ctx points to an instance of HMAC.
+ @param[in] hash points to an instance of hash.
+ @param[in] pprk points to pseudorandom key.
+ @param[in] nprk length of pseudorandom key.
+ @return the execution state of the function.
+  @retval 0 success
+*/
+int hkdf_init(hmac_s *ctx, const hash_s *hash, const void *pprk, size_t nprk);
+
+/*!
+ @brief Expand a prepared pseudorandom key into output keying material.
+ @param[in] ctx points to an instance of HMAC prepared by hkdf_init, it is left untouched.
+ @param[in] pinfo points to context and application specific information.
+ @param[in] ninfo length of information.
+ @param[out] out where to store the output keying material.
+ @param[in] siz length of output keying material, at most 255 * hash->outsiz.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -4 siz is too large
+*/
+int hkdf_expand(const hmac_s *ctx, const void *pinfo, size_t ninfo, void *out, size_t siz);
+
+/*!
+ @brief Extract and expand in one call.
+ @param[in] hash points to an instance of hash.
+ @param[in] psalt points to salt.
+ @param[in] nsalt length of salt.
+ @param[in] pikm points to input keying material.
+ @param[in] nikm length of input keying material.
+ @param[in] pinfo points to context and application specific information.
+ @param[in] ninfo length of information.
+ @param[out] out where to store the output keying material.
+ @param[in] siz length of output keying material, at most 255 * hash->outsiz.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -4 siz is too large
+*/
+int hkdf(const hash_s *hash, const void *psalt, size_t nsalt, const void *pikm, size_t nikm,
+         const void *pinfo, size_t ninfo, void *out, size_t siz);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __CKSUM_UTIL_HKDF_H__ */
@@ -0,0 +1,55 @@
+/*!
+ @file state.h
+ @brief hash state serialization
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __CKSUM_UTIL_STATE_H__
+#define __CKSUM_UTIL_STATE_H__
+
+#include "../hash.h"
+
+/*!
+ version of the serialized hash state
+*/
+#define HASH_STATE_VERSION 1
+/*!
+ max size of a serialized hash state
+*/
+#define HASH_STATE_BUFSIZ 0x100
+
+#if defined(__cplusplus)
+extern "C" {
+#endif /* __cplusplus */
+
+/*!
+ @brief Export a running hash state as a versioned, endian-neutral blob.
+ @param[in] ctx points to an instance of hash.
+ @param[in] hash points to the running hash state of ctx.
+ @param[out] out where to store the blob.
+ @param[in,out] siz max size and resulting size of the blob.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -4 the buffer is too small, siz holds the needed size
+  @retval -5 the hash is not a builtin one
+*/
+int hash_state_export(const hash_s *ctx, const hash_u *hash, void *out, size_t *siz);
+
+/*!
+ @brief Import a blob produced by hash_state_export to resume hashing.
+ @param[in] ctx points to an instance of hash, it must match the exported one.
+ @param[out] hash points to the hash state to restore.
+ @param[in] pdata points to the blob.
+ @param[in] nbyte length of the blob.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -3 the blob is malformed, of another version or of another hash
+  @retval -5 the hash is not a builtin one
+*/
+int hash_state_import(const hash_s *ctx, hash_u *hash, const void *pdata, size_t nbyte);
+
+#if defined(__cplusplus)
+}
+#endif /* __cplusplus */
+
+#endif /* __CKSUM_UTIL_STATE_H__ */
@@ -0,0 +1,111 @@
+/*!
+ @file arena.c
+ @brief bump allocator
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#include "cipher/a/arena.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#undef align
+#define align(x) (((x) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
+
+c_arena_s *c_arena_new(void)
+{
+    c_arena_s *ctx = (c_arena_s *)malloc(sizeof(c_arena_s));
+    if (ctx)
+    {
+        c_arena_ctor(ctx);
+    }
+    return ctx;
+}
+
+void c_arena_die(c_arena_s *ctx)
+{
+    if (ctx)
+    {
+        c_arena_dtor(ctx);
+        free(ctx);
+    }
+}
+
+void c_arena_ctor(c_arena_s *ctx)
+{
+    assert(ctx);
+    ctx->__page = NULL;
+    ctx->__cur = NULL;
+    ctx->__end = NULL;
+}
+
+void c_arena_dtor(c_arena_s *ctx)
+{
+    assert(ctx);
+    while (ctx->__page)
+    {
+        void *page = ctx->__page;
+        memcpy(&ctx->__page, page, sizeof(void *));
+        free(page);
+    }
+    ctx->__cur = NULL;
+    ctx->__end = NULL;
+}
+
+void *c_arena_alloc(c_arena_s *ctx, size_t siz)
+{
+    assert(ctx);
+    siz = align(siz ? siz : 1);
+    if (siz <= (size_t)(ctx->__end - ctx->__cur))
+    {
+        void *ptr = ctx->__cur;
+        ctx->__cur += siz;
+        return ptr;
+    }
+    if (siz > (C_ARENA_PAGE >> 2))
+    {
+        /* a large block goes behind the current page, whose free space is kept */
+        char *page = (char *)malloc(sizeof(void *) + siz);
+        if (page == NULL)
+        {
+            return NULL;
+        }
+        if (ctx->__page)
+        {
+            memcpy(page, ctx->__page, sizeof(void *));
+            memcpy(ctx->__page, &page, sizeof(void *));
+        }
+        else
+        {
+            memset(page, 0, sizeof(void *));
+            ctx->__page = page;
+            ctx->__cur = page + sizeof(void *) + siz;
+            ctx->__end = ctx->__cur;
+        }
+        return page + sizeof(void *);
+    }
+    char *page = (char *)malloc(C_ARENA_PAGE);
+    if (page == NULL)
+    {
+        return NULL;
+    }
+    memcpy(page, &ctx->__page, sizeof(void *));
+    ctx->__page = page;
+    ctx->__cur = page + sizeof(void *) + siz;
+    ctx->__end = page + C_ARENA_PAGE;
+    return page + sizeof(void *);
+}
+
+str_t c_arena_strndup(c_arena_s *ctx, cptr_t str, size_t len)
+{
+    str_t ptr = (str_t)c_arena_alloc(ctx, len + 1);
+    if (ptr)
+    {
+        memcpy(ptr, str, len);
+        ptr[len] = 0;
+    }
+    return ptr;
+}
+
+#undef align
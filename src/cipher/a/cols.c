@@ -0,0 +1,369 @@
+/*!
+ @file cols.c
+ @brief columnar snapshot of cipher infomation
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#undef _GNU_SOURCE
+#define _GNU_SOURCE /* memmem */
+
+#include "cipher/a/cols.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#undef COLS_X86
+#define COLS_X86
+#include <immintrin.h>
+#undef COLS_AVX2
+#define COLS_AVX2 __attribute__((target("avx2")))
+#endif /* __x86_64__ || __i386__ */
+
+static inline byte_t c_cols_fold_(byte_t c)
+{
+    return (byte_t)(c >= 'A' && c <= 'Z' ? c | 0x20 : c);
+}
+
+static u64_t c_cols_mask_(cstr_t str)
+{
+    u64_t mask = 0;
+    for (; *str; ++str)
+    {
+        mask |= (u64_t)1 << (c_cols_fold_((byte_t)*str) & 63);
+    }
+    return mask;
+}
+
+void c_cols_ctor(c_cols_s *ctx)
+{
+    ctx->text = NULL;
+    ctx->off = NULL;
+    ctx->pos = NULL;
+    ctx->type = NULL;
+    ctx->size = NULL;
+    ctx->hash = NULL;
+    ctx->mask = NULL;
+    ctx->num = 0;
+}
+
+void c_cols_dtor(c_cols_s *ctx)
+{
+    free(ctx->text);
+    free(ctx->off);
+    free(ctx->pos);
+    free(ctx->type);
+    free(ctx->size);
+    free(ctx->hash);
+    free(ctx->mask);
+    c_cols_ctor(ctx);
+}
+
+int c_cols_build(c_cols_s *ctx, const c_info_s *info)
+{
+    c_cols_dtor(ctx);
+    /* the entries bound the rows, only the packed texts grow */
+    size_t num = c_info_num(info);
+    size_t mem = num << 4;
+    ctx->text = (char *)malloc(mem + 1);
+    ctx->off = (size_t *)malloc(sizeof(size_t) * (num + 1));
+    ctx->pos = (size_t *)malloc(sizeof(size_t) * (num + 1));
+    ctx->type = (byte_t *)malloc(num + 1);
+    ctx->size = (byte_t *)malloc(num + 1);
+    ctx->hash = (byte_t *)malloc(num + 1);
+    ctx->mask = (u64_t *)malloc(sizeof(u64_t) * (num + 1));
+    if (!ctx->text || !ctx->off || !ctx->pos || !ctx->type || !ctx->size || !ctx->hash || !ctx->mask)
+    {
+        goto fail;
+    }
+    size_t siz = 0;
+    size_t row = 0;
+    c_info_forenum(i, info)
+    {
+        const cipher_s *it = c_info_at(info, i);
+        cstr_t text = cipher_get_text(it);
+        if (text == NULL)
+        {
+            continue;
+        }
+        size_t len = strlen(text) + 1;
+        if (mem < siz + len)
+        {
+            do
+            {
+                mem += (mem >> 1) + 1;
+            } while (mem < siz + len);
+            char *ptr = (char *)realloc(ctx->text, mem);
+            if (ptr == NULL)
+            {
+                goto fail;
+            }
+            ctx->text = ptr;
+        }
+        memcpy(ctx->text + siz, text, len);
+        ctx->off[row] = siz;
+        ctx->pos[row] = i;
+        ctx->type[row] = (byte_t)cipher_get_type(it);
+        ctx->size[row] = (byte_t)cipher_get_size(it);
+        int id = cipher_get_hash(it) ? cipher_hash_id(cipher_get_hash(it)) : 0;
+        ctx->hash[row] = id < 0 ? 0xFF : (byte_t)id;
+        ctx->mask[row] = c_cols_mask_(text);
+        siz += len;
+        ++row;
+    }
+    ctx->off[row] = siz;
+    ctx->num = row;
+    return SUCCESS;
+fail:
+    c_cols_dtor(ctx);
+    return FAILURE;
+}
+
+size_t c_cols_next(const c_cols_s *ctx, size_t row, cstr_t str)
+{
+    size_t num = ctx->num;
+    size_t len = strlen(str);
+    if (row >= num || len == 0)
+    {
+        return row < num ? row : num;
+    }
+#if defined(__GLIBC__)
+    /* one search over the packed texts, str has no null so a match stays in a text */
+    cstr_t ptr = ctx->text + ctx->off[row];
+    ptr = (cstr_t)memmem(ptr, ctx->off[num] - ctx->off[row], str, len);
+    if (ptr == NULL)
+    {
+        return num;
+    }
+    size_t off = (size_t)(ptr - ctx->text);
+    size_t end = num;
+    while (row + 1 < end)
+    {
+        size_t mid = row + ((end - row) >> 1);
+        if (ctx->off[mid] <= off)
+        {
+            row = mid;
+        }
+        else
+        {
+            end = mid;
+        }
+    }
+    return row;
+#else /* !__GLIBC__ */
+    for (; row != num; ++row)
+    {
+        if (strstr(ctx->text + ctx->off[row], str))
+        {
+            return row;
+        }
+    }
+    return num;
+#endif /* __GLIBC__ */
+}
+
+/*
+ The prefilter keeps the rows whose mask holds every bit of the query,
+ it writes their numbers to out and returns how many there are.
+*/
+typedef size_t (*c_cols_filter_f)(const u64_t *, size_t, size_t, u64_t, size_t *);
+
+static size_t c_cols_filter(const u64_t *mask, size_t row, size_t end, u64_t q, size_t *out)
+{
+    size_t n = 0;
+    for (; row != end; ++row)
+    {
+        out[n] = row;
+        n += (mask[row] & q) == q;
+    }
+    return n;
+}
+
+#if defined(COLS_X86)
+
+COLS_AVX2 static size_t c_cols_filter_avx2(const u64_t *mask, size_t row, size_t end, u64_t q, size_t *out)
+{
+    size_t n = 0;
+    const __m256i x = _mm256_set1_epi64x((long long)q);
+    for (; row + 4 <= end; row += 4)
+    {
+        __m256i m = _mm256_loadu_si256((const __m256i *)(mask + row));
+        int hit = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(m, x), x)));
+        for (; hit; hit &= hit - 1)
+        {
+            out[n++] = row + (size_t)__builtin_ctz((unsigned int)hit);
+        }
+    }
+    return n + c_cols_filter(mask, row, end, q, out + n);
+}
+
+static c_cols_filter_f c_cols_filter_pick(void)
+{
+    return __builtin_cpu_supports("avx2") ? c_cols_filter_avx2 : c_cols_filter;
+}
+#else /* !COLS_X86 */
+static c_cols_filter_f c_cols_filter_pick(void)
+{
+    return c_cols_filter;
+}
+#endif /* COLS_X86 */
+
+#undef COLS_SCORE_MATCH
+#define COLS_SCORE_MATCH 16
+#undef COLS_SCORE_GAP_START
+#define COLS_SCORE_GAP_START (-3)
+#undef COLS_SCORE_GAP_EXTENSION
+#define COLS_SCORE_GAP_EXTENSION (-1)
+#undef COLS_BONUS_BOUNDARY
+#define COLS_BONUS_BOUNDARY (COLS_SCORE_MATCH / 2)
+#undef COLS_BONUS_NONWORD
+#define COLS_BONUS_NONWORD (COLS_SCORE_MATCH / 2)
+#undef COLS_BONUS_CAMEL
+#define COLS_BONUS_CAMEL (COLS_BONUS_BOUNDARY + COLS_SCORE_GAP_EXTENSION)
+#undef COLS_BONUS_CONSECUTIVE
+#define COLS_BONUS_CONSECUTIVE (-(COLS_SCORE_GAP_START + COLS_SCORE_GAP_EXTENSION))
+#undef COLS_BONUS_FIRST
+#define COLS_BONUS_FIRST 2
+
+enum
+{
+    COLS_NONWORD,
+    COLS_LOWER,
+    COLS_UPPER,
+    COLS_DIGIT,
+};
+
+static int c_cols_class_(byte_t c)
+{
+    if (c >= 'a' && c <= 'z')
+    {
+        return COLS_LOWER;
+    }
+    if (c >= 'A' && c <= 'Z')
+    {
+        return COLS_UPPER;
+    }
+    if (c >= '0' && c <= '9')
+    {
+        return COLS_DIGIT;
+    }
+    /* the bytes of UTF-8 are letters */
+    return c & 0x80 ? COLS_LOWER : COLS_NONWORD;
+}
+
+static int c_cols_bonus_(int prev, int cls)
+{
+    if (prev == COLS_NONWORD && cls != COLS_NONWORD)
+    {
+        return COLS_BONUS_BOUNDARY;
+    }
+    if ((prev == COLS_LOWER && cls == COLS_UPPER) || (prev != COLS_DIGIT && cls == COLS_DIGIT))
+    {
+        return COLS_BONUS_CAMEL;
+    }
+    return cls == COLS_NONWORD ? COLS_BONUS_NONWORD : 0;
+}
+
+/*
+ The first match in text is found forward, then shortened backward from its
+ end, and the window is scored. It returns INT_MIN when str is not in text.
+*/
+static int c_cols_score_(cstr_t text, size_t len, cstr_t str)
+{
+    size_t end = 0;
+    cstr_t s = str;
+    for (; end != len && *s; ++end)
+    {
+        s += c_cols_fold_((byte_t)text[end]) == c_cols_fold_((byte_t)*s);
+    }
+    if (*s)
+    {
+        return INT_MIN;
+    }
+    size_t beg = end;
+    while (s != str)
+    {
+        s -= c_cols_fold_((byte_t)text[--beg]) == c_cols_fold_((byte_t)s[-1]);
+    }
+
+    int score = 0;
+    int bonus1 = 0;
+    int ingap = 0;
+    size_t run = 0;
+    int prev = beg ? c_cols_class_((byte_t)text[beg - 1]) : COLS_NONWORD;
+    for (size_t i = beg; i != end; ++i)
+    {
+        int cls = c_cols_class_((byte_t)text[i]);
+        if (c_cols_fold_((byte_t)text[i]) == c_cols_fold_((byte_t)*s))
+        {
+            int bonus = c_cols_bonus_(prev, cls);
+            if (run == 0)
+            {
+                bonus1 = bonus;
+            }
+            else
+            {
+                /* a run keeps the bonus of the boundary it starts at */
+                if (bonus >= COLS_BONUS_BOUNDARY && bonus > bonus1)
+                {
+                    bonus1 = bonus;
+                }
+                bonus = bonus > bonus1 ? bonus : bonus1;
+                bonus = bonus > COLS_BONUS_CONSECUTIVE ? bonus : COLS_BONUS_CONSECUTIVE;
+            }
+            score += COLS_SCORE_MATCH + (s == str ? bonus * COLS_BONUS_FIRST : bonus);
+            ingap = 0;
+            ++run;
+            ++s;
+        }
+        else
+        {
+            score += ingap ? COLS_SCORE_GAP_EXTENSION : COLS_SCORE_GAP_START;
+            ingap = 1;
+            run = 0;
+            bonus1 = 0;
+        }
+        prev = cls;
+    }
+    return score;
+}
+
+#undef COLS_SCORE_MATCH
+#undef COLS_SCORE_GAP_START
+#undef COLS_SCORE_GAP_EXTENSION
+#undef COLS_BONUS_BOUNDARY
+#undef COLS_BONUS_NONWORD
+#undef COLS_BONUS_CAMEL
+#undef COLS_BONUS_CONSECUTIVE
+#undef COLS_BONUS_FIRST
+
+size_t c_cols_fuzzy(const c_cols_s *ctx, cstr_t str, c_cols_hit_s *top, size_t k)
+{
+    size_t n = 0;
+    size_t row[0x100];
+    u64_t q = c_cols_mask_(str);
+    c_cols_filter_f filter = c_cols_filter_pick();
+    for (size_t beg = 0; beg < ctx->num && k; beg += 0x100)
+    {
+        size_t end = ctx->num - beg < 0x100 ? ctx->num : beg + 0x100;
+        size_t num = filter(ctx->mask, beg, end, q, row);
+        for (size_t i = 0; i != num; ++i)
+        {
+            int score = c_cols_score_(c_cols_text(ctx, row[i]), c_cols_len(ctx, row[i]), str);
+            if (score == INT_MIN || (n == k && score <= top[n - 1].score))
+            {
+                continue;
+            }
+            /* keep the best k in order, a later row goes after an equal score */
+            size_t j = n < k ? n++ : n - 1;
+            for (; j && top[j - 1].score < score; --j)
+            {
+                top[j] = top[j - 1];
+            }
+            top[j].row = row[i];
+            top[j].score = score;
+        }
+    }
+    return n;
+}
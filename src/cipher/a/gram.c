@@ -0,0 +1,270 @@
+/*!
+ @file gram.c
+ @brief trigram index of strings
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#include "cipher/a/gram.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* number of posting lists that are intersected at most */
+#undef C_GRAM_PROBE
+#define C_GRAM_PROBE 0x20
+
+static inline uint_t c_gram_key_(cstr_t str)
+{
+    return ((uint_t)(byte_t)str[0] << 16 | (uint_t)(byte_t)str[1] << 8 | (uint_t)(byte_t)str[2]) + 1;
+}
+
+static inline size_t c_gram_hash_(uint_t key)
+{
+    return (size_t)(key * 0x9E3779B1U);
+}
+
+/* the first index of the list whose position is not less than pos */
+static uint_t c_gram_bound_(const c_gram_list_s *list, size_t pos)
+{
+    uint_t lo = 0;
+    uint_t hi = list->num;
+    while (lo < hi)
+    {
+        uint_t mid = lo + ((hi - lo) >> 1);
+        if (list->pos[mid] < pos)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static c_gram_list_s *c_gram_find_(const c_gram_s *ctx, uint_t key)
+{
+    if (ctx->__len == 0)
+    {
+        return NULL;
+    }
+    size_t mask = ctx->__mem - 1;
+    for (size_t i = c_gram_hash_(key) & mask; ctx->__list[i].key; i = (i + 1) & mask)
+    {
+        if (ctx->__list[i].key == key)
+        {
+            return ctx->__list + i;
+        }
+    }
+    return NULL;
+}
+
+static int c_gram_grow_(c_gram_s *ctx)
+{
+    size_t mem = ctx->__mem ? ctx->__mem << 1 : 0x100;
+    c_gram_list_s *list = (c_gram_list_s *)calloc(mem, sizeof(c_gram_list_s));
+    if (list == NULL)
+    {
+        return FAILURE;
+    }
+    for (size_t i = 0; i != ctx->__mem; ++i)
+    {
+        if (ctx->__list[i].key)
+        {
+            size_t j = c_gram_hash_(ctx->__list[i].key) & (mem - 1);
+            while (list[j].key)
+            {
+                j = (j + 1) & (mem - 1);
+            }
+            list[j] = ctx->__list[i];
+        }
+    }
+    free(ctx->__list);
+    ctx->__list = list;
+    ctx->__mem = mem;
+    return SUCCESS;
+}
+
+static c_gram_list_s *c_gram_make_(c_gram_s *ctx, uint_t key)
+{
+    c_gram_list_s *list = c_gram_find_(ctx, key);
+    if (list)
+    {
+        return list;
+    }
+    if (ctx->__mem < (ctx->__len + 1) << 1 && c_gram_grow_(ctx))
+    {
+        return NULL;
+    }
+    size_t mask = ctx->__mem - 1;
+    size_t i = c_gram_hash_(key) & mask;
+    while (ctx->__list[i].key)
+    {
+        i = (i + 1) & mask;
+    }
+    ++ctx->__len;
+    ctx->__list[i].key = key;
+    return ctx->__list + i;
+}
+
+c_gram_s *c_gram_new(void)
+{
+    c_gram_s *ctx = (c_gram_s *)malloc(sizeof(c_gram_s));
+    if (ctx)
+    {
+        c_gram_ctor(ctx);
+    }
+    return ctx;
+}
+
+void c_gram_die(c_gram_s *ctx)
+{
+    if (ctx)
+    {
+        c_gram_dtor(ctx);
+        free(ctx);
+    }
+}
+
+void c_gram_ctor(c_gram_s *ctx)
+{
+    assert(ctx);
+    ctx->__list = NULL;
+    ctx->__mem = 0;
+    ctx->__len = 0;
+}
+
+void c_gram_dtor(c_gram_s *ctx)
+{
+    assert(ctx);
+    for (size_t i = 0; i != ctx->__mem; ++i)
+    {
+        free(ctx->__list[i].pos);
+    }
+    free(ctx->__list);
+    c_gram_ctor(ctx);
+}
+
+int c_gram_put(c_gram_s *ctx, size_t pos, cstr_t str)
+{
+    assert(ctx);
+    assert(str);
+    for (; str[0] && str[1] && str[2]; ++str)
+    {
+        c_gram_list_s *list = c_gram_make_(ctx, c_gram_key_(str));
+        if (list == NULL)
+        {
+            return FAILURE;
+        }
+        /* the strings are mostly added in order, so the position goes last */
+        uint_t i = list->num;
+        if (i && list->pos[i - 1] >= pos)
+        {
+            i = c_gram_bound_(list, pos);
+            if (list->pos[i] == pos)
+            {
+                continue;
+            }
+        }
+        if (list->num == list->mem)
+        {
+            uint_t mem = list->mem + (list->mem >> 1) + 1;
+            uint_t *ptr = (uint_t *)realloc(list->pos, sizeof(uint_t) * mem);
+            if (ptr == NULL)
+            {
+                return FAILURE;
+            }
+            list->pos = ptr;
+            list->mem = mem;
+        }
+        memmove(list->pos + i + 1, list->pos + i, sizeof(uint_t) * (list->num - i));
+        list->pos[i] = (uint_t)pos;
+        ++list->num;
+    }
+    return SUCCESS;
+}
+
+void c_gram_del(c_gram_s *ctx, size_t pos, cstr_t str)
+{
+    assert(ctx);
+    assert(str);
+    for (; str[0] && str[1] && str[2]; ++str)
+    {
+        c_gram_list_s *list = c_gram_find_(ctx, c_gram_key_(str));
+        if (list == NULL)
+        {
+            continue;
+        }
+        /* a trigram that repeats in str is removed once */
+        uint_t i = c_gram_bound_(list, pos);
+        if (i != list->num && list->pos[i] == pos)
+        {
+            --list->num;
+            memmove(list->pos + i, list->pos + i + 1, sizeof(uint_t) * (list->num - i));
+        }
+    }
+}
+
+void c_gram_cut(c_gram_s *ctx, size_t pos)
+{
+    assert(ctx);
+    for (size_t i = 0; i != ctx->__mem; ++i)
+    {
+        c_gram_list_s *list = ctx->__list + i;
+        if (list->num)
+        {
+            list->num = pos ? c_gram_bound_(list, pos) : 0;
+        }
+    }
+}
+
+size_t c_gram_next(const c_gram_s *ctx, cstr_t str, size_t pos)
+{
+    assert(ctx);
+    assert(str);
+    if (!str[0] || !str[1] || !str[2])
+    {
+        return pos;
+    }
+    /* walk the shortest list and probe the others, the candidates are checked anyway,
+       so the trigrams past the first C_GRAM_PROBE lists need not be probed */
+    const c_gram_list_s *list[C_GRAM_PROBE];
+    unsigned int n = 0;
+    unsigned int min = 0;
+    for (cstr_t s = str; s[0] && s[1] && s[2]; ++s)
+    {
+        const c_gram_list_s *it = c_gram_find_(ctx, c_gram_key_(s));
+        if (it == NULL || it->num == 0)
+        {
+            return ~(size_t)0;
+        }
+        if (n != C_GRAM_PROBE)
+        {
+            min = n == 0 || it->num < list[min]->num ? n : min;
+            list[n++] = it;
+        }
+    }
+    for (uint_t k = c_gram_bound_(list[min], pos); k != list[min]->num; ++k)
+    {
+        uint_t at = list[min]->pos[k];
+        unsigned int j = 0;
+        for (; j != n; ++j)
+        {
+            if (j != min)
+            {
+                uint_t i = c_gram_bound_(list[j], at);
+                if (i == list[j]->num || list[j]->pos[i] != at)
+                {
+                    break;
+                }
+            }
+        }
+        if (j == n)
+        {
+            return at;
+        }
+    }
+    return ~(size_t)0;
+}
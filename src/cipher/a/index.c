@@ -0,0 +1,506 @@
+/*!
+ @file index.c
+ @brief text index and slot map of a vector
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#include "cipher/a/index.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* FNV-1a */
+static size_t c_index_hash_(cstr_t text)
+{
+    u64_t x = 0xCBF29CE484222325;
+    for (; *text; ++text)
+    {
+        x ^= (byte_t)*text;
+        x *= 0x100000001B3;
+    }
+    return (size_t)(x ^ (x >> 32));
+}
+
+static inline void c_index_gram_del_(c_index_s *ctx, size_t pos, cstr_t text)
+{
+    if (text)
+    {
+        c_gram_del(ctx->__gram, pos, text);
+    }
+}
+
+static inline int c_index_gram_put_(c_index_s *ctx, size_t pos, cstr_t text)
+{
+    return text ? c_gram_put(ctx->__gram, pos, text) : SUCCESS;
+}
+
+/* drop the elements from pos on out of the trigram index */
+static void c_index_gram_cut_(c_index_s *ctx, const void *head, size_t pos)
+{
+    if (ctx->__gram_num <= pos)
+    {
+        return;
+    }
+    if (ctx->__gram_num - pos > 0x10)
+    {
+        c_gram_cut(ctx->__gram, pos);
+        ctx->__gram_num = pos;
+        return;
+    }
+    /* a few elements are quicker to remove one by one than to cut every list */
+    while (ctx->__gram_num > pos)
+    {
+        --ctx->__gram_num;
+        c_index_gram_del_(ctx, ctx->__gram_num, ctx->__text(head, ctx->__gram_num));
+    }
+}
+
+static int c_index_gram_sync_(c_index_s *ctx, const void *head, size_t num)
+{
+    if (ctx->__gram == NULL)
+    {
+        ctx->__gram = c_gram_new();
+        if (ctx->__gram == NULL)
+        {
+            return FAILURE;
+        }
+    }
+    for (; ctx->__gram_num < num; ++ctx->__gram_num)
+    {
+        if (c_index_gram_put_(ctx, ctx->__gram_num, ctx->__text(head, ctx->__gram_num)))
+        {
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+static int c_index_grow_(c_index_s *ctx)
+{
+    size_t mem = ctx->__mem ? ctx->__mem << 1 : 0x10;
+    size_t *slot = (size_t *)calloc(mem << 1, sizeof(size_t));
+    if (slot == NULL)
+    {
+        return FAILURE;
+    }
+    for (size_t i = 0; i != ctx->__mem; ++i)
+    {
+        size_t *old = ctx->__slot + (i << 1);
+        if (old[0])
+        {
+            size_t j = old[1] & (mem - 1);
+            while (slot[j << 1])
+            {
+                j = (j + 1) & (mem - 1);
+            }
+            slot[(j << 1) + 0] = old[0];
+            slot[(j << 1) + 1] = old[1];
+        }
+    }
+    free(ctx->__slot);
+    ctx->__slot = slot;
+    ctx->__mem = mem;
+    return SUCCESS;
+}
+
+static int c_index_put_(c_index_s *ctx, size_t pos, cstr_t text)
+{
+    if (text == NULL)
+    {
+        return SUCCESS;
+    }
+    /* keep the load factor at most one half */
+    if (ctx->__mem < (ctx->__len + 1) << 1 && c_index_grow_(ctx))
+    {
+        return FAILURE;
+    }
+    size_t mask = ctx->__mem - 1;
+    size_t hash = c_index_hash_(text);
+    size_t i = hash & mask;
+    while (ctx->__slot[i << 1])
+    {
+        i = (i + 1) & mask;
+    }
+    ctx->__slot[(i << 1) + 0] = pos + 1;
+    ctx->__slot[(i << 1) + 1] = hash;
+    ++ctx->__len;
+    return SUCCESS;
+}
+
+/* the slot of an indexed element, or __mem */
+static size_t c_index_at_(const c_index_s *ctx, size_t pos, cstr_t text)
+{
+    if (text == NULL || ctx->__len == 0)
+    {
+        return ctx->__mem;
+    }
+    size_t mask = ctx->__mem - 1;
+    for (size_t i = c_index_hash_(text) & mask; ctx->__slot[i << 1]; i = (i + 1) & mask)
+    {
+        if (ctx->__slot[i << 1] == pos + 1)
+        {
+            return i;
+        }
+    }
+    return ctx->__mem;
+}
+
+static void c_index_del_(c_index_s *ctx, size_t pos, cstr_t text)
+{
+    size_t i = c_index_at_(ctx, pos, text);
+    if (i == ctx->__mem)
+    {
+        return;
+    }
+    /* backward shift deletion keeps every probe sequence unbroken */
+    size_t mask = ctx->__mem - 1;
+    for (size_t j = i;;)
+    {
+        ctx->__slot[i << 1] = 0;
+        size_t home;
+        do
+        {
+            j = (j + 1) & mask;
+            if (ctx->__slot[j << 1] == 0)
+            {
+                --ctx->__len;
+                return;
+            }
+            home = ctx->__slot[(j << 1) + 1] & mask;
+        } while (i <= j ? (i < home && home <= j) : (i < home || home <= j));
+        ctx->__slot[(i << 1) + 0] = ctx->__slot[(j << 1) + 0];
+        ctx->__slot[(i << 1) + 1] = ctx->__slot[(j << 1) + 1];
+        i = j;
+    }
+}
+
+static int c_index_sync_(c_index_s *ctx, const void *head, size_t num)
+{
+    for (; ctx->__num < num; ++ctx->__num)
+    {
+        if (c_index_put_(ctx, ctx->__num, ctx->__text(head, ctx->__num)))
+        {
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+static void c_index_drop_(c_index_s *ctx)
+{
+    if (ctx->__slot)
+    {
+        memset(ctx->__slot, 0, sizeof(size_t) * 2 * ctx->__mem);
+    }
+    ctx->__len = 0;
+    ctx->__num = 0;
+    if (ctx->__gram_num)
+    {
+        c_gram_cut(ctx->__gram, 0);
+        ctx->__gram_num = 0;
+    }
+}
+
+void c_index_ctor(c_index_s *ctx, c_index_f text)
+{
+    assert(ctx);
+    assert(text);
+    ctx->__text = text;
+    ctx->__slot = NULL;
+    ctx->__mem = 0;
+    ctx->__len = 0;
+    ctx->__num = 0;
+    ctx->__gen = NULL;
+    ctx->__free = NULL;
+    ctx->__free_num = 0;
+    ctx->__free_mem = 0;
+    ctx->__gram = NULL;
+    ctx->__gram_num = 0;
+}
+
+void c_index_dtor(c_index_s *ctx)
+{
+    assert(ctx);
+    free(ctx->__slot);
+    free(ctx->__gen);
+    free(ctx->__free);
+    c_gram_die(ctx->__gram);
+    c_index_ctor(ctx, ctx->__text);
+}
+
+int c_index_copy(c_index_s *ctx, const c_index_s *obj, size_t mem)
+{
+    c_index_ctor(ctx, obj->__text);
+    if (c_index_alloc(ctx, 0, mem))
+    {
+        return FAILURE;
+    }
+    if (mem)
+    {
+        /* the handles of obj are valid for the copy */
+        memcpy(ctx->__gen, obj->__gen, sizeof(uint_t) * mem);
+    }
+    return SUCCESS;
+}
+
+int c_index_alloc(c_index_s *ctx, size_t old, size_t mem)
+{
+    if (mem == 0)
+    {
+        free(ctx->__gen);
+        free(ctx->__free);
+        ctx->__gen = NULL;
+        ctx->__free = NULL;
+        ctx->__free_num = 0;
+        ctx->__free_mem = 0;
+        return SUCCESS;
+    }
+    if (old < mem)
+    {
+        uint_t *gen = (uint_t *)realloc(ctx->__gen, sizeof(uint_t) * mem);
+        if (gen == NULL)
+        {
+            return FAILURE;
+        }
+        memset(gen + old, 0, sizeof(uint_t) * (mem - old));
+        ctx->__gen = gen;
+        size_t *fre = (size_t *)realloc(ctx->__free, sizeof(size_t) * mem);
+        if (fre == NULL)
+        {
+            return FAILURE;
+        }
+        ctx->__free = fre;
+        ctx->__free_mem = mem;
+    }
+    else if (mem < old)
+    {
+        /* the old memory is kept when it can not be shrunk */
+        uint_t *gen = (uint_t *)realloc(ctx->__gen, sizeof(uint_t) * mem);
+        ctx->__gen = gen ? gen : ctx->__gen;
+        size_t *fre = (size_t *)realloc(ctx->__free, sizeof(size_t) * mem);
+        ctx->__free = fre ? fre : ctx->__free;
+        ctx->__free_mem = fre ? mem : ctx->__free_mem;
+    }
+    return SUCCESS;
+}
+
+void c_index_clear(c_index_s *ctx)
+{
+    c_index_drop_(ctx);
+    ctx->__free_num = 0;
+}
+
+int c_index_reindex(c_index_s *ctx, const void *head, size_t num)
+{
+    c_index_drop_(ctx);
+    return c_index_sync_(ctx, head, num);
+}
+
+void c_index_cut(c_index_s *ctx, const void *head, size_t pos)
+{
+    if (pos == 0)
+    {
+        c_index_drop_(ctx);
+    }
+    c_index_gram_cut_(ctx, head, pos);
+    while (ctx->__num > pos)
+    {
+        --ctx->__num;
+        c_index_del_(ctx, ctx->__num, ctx->__text(head, ctx->__num));
+    }
+}
+
+void c_index_bump(c_index_s *ctx, size_t pos, size_t end)
+{
+    for (; pos < end; ++pos)
+    {
+        ++ctx->__gen[pos];
+    }
+}
+
+void c_index_scan(c_index_s *ctx, const void *head, size_t num)
+{
+    ctx->__free_num = 0;
+    for (size_t pos = num; pos--;)
+    {
+        if (ctx->__text(head, pos) == NULL)
+        {
+            ctx->__free[ctx->__free_num++] = pos;
+        }
+    }
+}
+
+void c_index_swap(c_index_s *ctx, const void *head, size_t lhs, size_t rhs)
+{
+    cstr_t l_text = ctx->__text(head, lhs);
+    cstr_t r_text = ctx->__text(head, rhs);
+    size_t min = lhs < rhs ? lhs : rhs;
+    if (lhs < ctx->__num && rhs < ctx->__num)
+    {
+        /* the slots follow the texts to their new positions */
+        size_t l = c_index_at_(ctx, lhs, l_text);
+        size_t r = c_index_at_(ctx, rhs, r_text);
+        if (l != ctx->__mem)
+        {
+            ctx->__slot[l << 1] = rhs + 1;
+        }
+        if (r != ctx->__mem)
+        {
+            ctx->__slot[r << 1] = lhs + 1;
+        }
+    }
+    else
+    {
+        c_index_cut(ctx, head, min);
+    }
+    int gram = lhs < ctx->__gram_num && rhs < ctx->__gram_num;
+    if (gram)
+    {
+        /* the trigrams follow the texts to their new positions */
+        c_index_gram_del_(ctx, lhs, l_text);
+        c_index_gram_del_(ctx, rhs, r_text);
+    }
+    else
+    {
+        c_index_gram_cut_(ctx, head, min);
+    }
+    ++ctx->__gen[lhs];
+    ++ctx->__gen[rhs];
+    if (gram && (c_index_gram_put_(ctx, lhs, r_text) || c_index_gram_put_(ctx, rhs, l_text)))
+    {
+        c_index_gram_cut_(ctx, head, min);
+    }
+    if (!l_text != !r_text)
+    {
+        /* a free slot follows its element */
+        for (size_t i = 0; i != ctx->__free_num; ++i)
+        {
+            if (ctx->__free[i] == lhs)
+            {
+                ctx->__free[i] = rhs;
+            }
+            else if (ctx->__free[i] == rhs)
+            {
+                ctx->__free[i] = lhs;
+            }
+        }
+    }
+}
+
+size_t c_index_find(c_index_s *ctx, const void *head, size_t num, cstr_t text)
+{
+    if (text == NULL)
+    {
+        return num;
+    }
+    if (c_index_sync_(ctx, head, num))
+    {
+        /* out of memory for the index, look through every element */
+        for (size_t pos = 0; pos != num; ++pos)
+        {
+            cstr_t str = ctx->__text(head, pos);
+            if (str && strcmp(str, text) == 0)
+            {
+                return pos;
+            }
+        }
+        return num;
+    }
+    if (ctx->__len == 0)
+    {
+        return num;
+    }
+    size_t ret = num;
+    size_t mask = ctx->__mem - 1;
+    size_t hash = c_index_hash_(text);
+    for (size_t i = hash & mask; ctx->__slot[i << 1]; i = (i + 1) & mask)
+    {
+        if (ctx->__slot[(i << 1) + 1] == hash)
+        {
+            /* equal texts may be indexed more than once, keep the first element */
+            size_t pos = ctx->__slot[i << 1] - 1;
+            cstr_t str = ctx->__text(head, pos);
+            if (pos < ret && str && strcmp(str, text) == 0)
+            {
+                ret = pos;
+            }
+        }
+    }
+    return ret;
+}
+
+void c_index_forget(c_index_s *ctx, const void *head, size_t pos)
+{
+    cstr_t text = ctx->__text(head, pos);
+    if (pos < ctx->__num)
+    {
+        c_index_del_(ctx, pos, text);
+    }
+    if (pos < ctx->__gram_num)
+    {
+        c_index_gram_del_(ctx, pos, text);
+    }
+}
+
+int c_index_remember(c_index_s *ctx, const void *head, size_t pos)
+{
+    cstr_t text = ctx->__text(head, pos);
+    if (pos < ctx->__gram_num && c_index_gram_put_(ctx, pos, text))
+    {
+        /* indexed again by the next search */
+        c_index_gram_cut_(ctx, head, pos);
+    }
+    if (pos < ctx->__num && c_index_at_(ctx, pos, text) == ctx->__mem)
+    {
+        return c_index_put_(ctx, pos, text);
+    }
+    return SUCCESS;
+}
+
+size_t c_index_claim(c_index_s *ctx, const void *head, size_t num)
+{
+    while (ctx->__free_num)
+    {
+        /* positions that were popped or filled since are stale */
+        size_t pos = ctx->__free[--ctx->__free_num];
+        if (pos < num && ctx->__text(head, pos) == NULL)
+        {
+            return pos;
+        }
+    }
+    return num;
+}
+
+void c_index_erase(c_index_s *ctx, const void *head, size_t num, size_t pos)
+{
+    ++ctx->__gen[pos];
+    if (ctx->__free_num == ctx->__free_mem)
+    {
+        /* full of stale positions */
+        c_index_scan(ctx, head, num);
+    }
+    else
+    {
+        ctx->__free[ctx->__free_num++] = pos;
+    }
+}
+
+size_t c_index_get(const c_index_s *ctx, const void *head, size_t num, u64_t id)
+{
+    size_t pos = (size_t)(id & 0xFFFFFFFF);
+    if (pos < num && ctx->__gen[pos] == (uint_t)(id >> 32) && ctx->__text(head, pos))
+    {
+        return pos;
+    }
+    return num;
+}
+
+size_t c_index_next(c_index_s *ctx, const void *head, size_t num, cstr_t str, size_t pos)
+{
+    if (c_index_gram_sync_(ctx, head, num) == SUCCESS)
+    {
+        return c_gram_next(ctx->__gram, str, pos);
+    }
+    return pos;
+}
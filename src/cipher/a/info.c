@@ -18,6 +18,11 @@ static inline size_t c_info_mem_(const c_info_s *ctx)
     return (size_t)(ctx->last - ctx->head);
 }
 
+static cstr_t c_info_text_(const void *head, size_t pos)
+{
+    return cipher_get_text((const cipher_s *)head + pos);
+}
+
 c_info_s *c_info_new(void)
 {
     c_info_s *ctx = (c_info_s *)malloc(sizeof(c_info_s));
@@ -42,6 +47,9 @@ void c_info_ctor(c_info_s *ctx)
     ctx->head = NULL;
     ctx->tail = NULL;
     ctx->last = NULL;
+    c_index_ctor(ctx->__index, c_info_text_);
+    ctx->__arena = NULL;
+    c_log_ctor(ctx->__log);
 }
 
 void c_info_dtor(c_info_s *ctx)
@@ -54,15 +62,23 @@ void c_info_dtor(c_info_s *ctx)
     }
     ctx->tail = NULL;
     ctx->last = NULL;
+    c_index_dtor(ctx->__index);
+    c_arena_die(ctx->__arena);
+    ctx->__arena = NULL;
+    c_log_dtor(ctx->__log);
 }
 
 int c_info_copy(c_info_s *ctx, const c_info_s *obj)
 {
     size_t num = c_info_num_(obj);
     size_t mem = c_info_mem_(obj);
+    c_info_ctor(ctx);
     ctx->head = (cipher_s *)malloc(sizeof(cipher_s) * mem);
-    if (ctx->head == NULL)
+    if (ctx->head == NULL || c_index_copy(ctx->__index, obj->__index, mem))
     {
+        /* there is no entry to destruct yet */
+        ctx->tail = ctx->head;
+        c_info_dtor(ctx);
         return FAILURE;
     }
     ctx->tail = ctx->head + num;
@@ -73,46 +89,85 @@ int c_info_copy(c_info_s *ctx, const c_info_s *obj)
     {
         cipher_copy(dst, src);
     }
+    c_index_scan(ctx->__index, ctx->head, num);
     return SUCCESS;
 }
 
 c_info_s *c_info_move(c_info_s *ctx, c_info_s *obj)
 {
     memcpy(ctx, obj, sizeof(c_info_s));
-    memset(obj, 000, sizeof(c_info_s));
+    /* obj is left empty, and ready for use */
+    c_info_ctor(obj);
     return ctx;
 }
 
 void c_info_drop(c_info_s *ctx)
 {
+    size_t num = c_info_num_(ctx);
+    c_index_clear(ctx->__index);
+    c_index_bump(ctx->__index, 0, num);
     while (ctx->head != ctx->tail)
     {
         --ctx->tail;
         cipher_dtor(ctx->tail);
     }
+    if (ctx->__arena)
+    {
+        /* no entry refers to the arena any more */
+        c_arena_dtor(ctx->__arena);
+    }
 }
 
 #undef align
 #define align(x) ((sizeof(cipher_s) * (x) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
 
+/* resize the memory to exactly mem entries, it holds every entry */
+static int c_info_realloc(c_info_s *ctx, size_t mem)
+{
+    size_t n = c_info_num_(ctx);
+    size_t old = c_info_mem_(ctx);
+    if (mem == 0)
+    {
+        free(ctx->head);
+        ctx->head = NULL;
+        ctx->tail = NULL;
+        ctx->last = NULL;
+        return c_index_alloc(ctx->__index, old, 0);
+    }
+    if (mem < n)
+    {
+        return FAILURE;
+    }
+    /* the side arrays are never shorter than the entries, even on failure */
+    if (old < mem && c_index_alloc(ctx->__index, old, mem))
+    {
+        return FAILURE;
+    }
+    cipher_s *head = (cipher_s *)realloc(ctx->head, align(mem));
+    if (head == NULL)
+    {
+        return FAILURE;
+    }
+    ctx->head = head;
+    ctx->tail = head + n;
+    ctx->last = head + mem;
+    if (mem < old)
+    {
+        c_index_alloc(ctx->__index, old, mem);
+    }
+    return SUCCESS;
+}
+
 static int c_info_alloc(c_info_s *ctx, size_t num)
 {
     size_t mem = c_info_mem_(ctx);
     if (mem <= num)
     {
-        size_t n = c_info_num_(ctx);
         do
         {
             mem += (mem >> 1) + 1;
         } while (mem < num);
-        cipher_s *head = (cipher_s *)realloc(ctx->head, align(mem));
-        if (head == NULL)
-        {
-            return FAILURE;
-        }
-        ctx->head = head;
-        ctx->tail = head + n;
-        ctx->last = head + mem;
+        return c_info_realloc(ctx, mem);
     }
     return SUCCESS;
 }
@@ -132,6 +187,7 @@ int c_info_swap(c_info_s *ctx, size_t lhs, size_t rhs)
     {
         return FAILURE;
     }
+    c_index_swap(ctx->__index, ctx->head, lhs, rhs);
     memcpy(ctx->head + num, ctx->head + lhs, sizeof(cipher_s));
     memcpy(ctx->head + lhs, ctx->head + rhs, sizeof(cipher_s));
     memcpy(ctx->head + rhs, ctx->head + num, sizeof(cipher_s));
@@ -147,11 +203,17 @@ cipher_s *c_info_insert(c_info_s *ctx, size_t idx)
     }
     if (idx < num)
     {
+        c_index_cut(ctx->__index, ctx->head, idx);
         cipher_s *ptr = ctx->tail;
         cipher_s *src = ctx->head + idx + 0;
         cipher_s *dst = ctx->head + idx + 1;
         memmove(dst, src, sizeof(cipher_s) * (size_t)(ptr - src));
         c_info_inc_(ctx);
+        c_index_bump(ctx->__index, idx, num + 1);
+        if (c_index_free_num(ctx->__index))
+        {
+            c_index_scan(ctx->__index, ctx->head, num + 1);
+        }
         return src;
     }
     return c_info_inc_(ctx);
@@ -181,15 +243,21 @@ cipher_s *c_info_remove(c_info_s *ctx, size_t idx)
         {
             return NULL;
         }
+        c_index_cut(ctx->__index, ctx->head, idx);
         cipher_s *ptr = ctx->tail;
         cipher_s *dst = ctx->head + idx + 0;
         cipher_s *src = ctx->head + idx + 1;
         memcpy(ptr, dst, sizeof(cipher_s));
         memmove(dst, src, sizeof(cipher_s) * (size_t)(ptr - src));
         c_info_dec_(ctx);
+        c_index_bump(ctx->__index, idx, num);
+        if (c_index_free_num(ctx->__index))
+        {
+            c_index_scan(ctx->__index, ctx->head, num - 1);
+        }
         return ptr;
     }
-    return ctx->head != ctx->tail ? c_info_inc_(ctx) : NULL;
+    return c_info_pop_back(ctx);
 }
 
 cipher_s *c_info_pop_fore(c_info_s *ctx)
@@ -199,5 +267,180 @@ cipher_s *c_info_pop_fore(c_info_s *ctx)
 
 cipher_s *c_info_pop_back(c_info_s *ctx)
 {
-    return ctx->head != ctx->tail ? c_info_dec_(ctx) : NULL;
+    if (ctx->head == ctx->tail)
+    {
+        return NULL;
+    }
+    /* a free slot that is popped stays in __free, c_info_claim skips it */
+    size_t num = c_info_num_(ctx);
+    c_index_cut(ctx->__index, ctx->head, num - 1);
+    c_index_bump(ctx->__index, num - 1, num);
+    return c_info_dec_(ctx);
+}
+
+cipher_s *c_info_find(c_info_s *ctx, cstr_t text)
+{
+    size_t num = c_info_num_(ctx);
+    size_t pos = c_index_find(ctx->__index, ctx->head, num, text);
+    return pos < num ? ctx->head + pos : NULL;
+}
+
+void c_info_forget(c_info_s *ctx, const cipher_s *obj)
+{
+    c_index_forget(ctx->__index, ctx->head, (size_t)(obj - ctx->head));
+}
+
+int c_info_reindex(c_info_s *ctx)
+{
+    return c_index_reindex(ctx->__index, ctx->head, c_info_num_(ctx));
+}
+
+int c_info_remember(c_info_s *ctx, const cipher_s *obj)
+{
+    return c_index_remember(ctx->__index, ctx->head, (size_t)(obj - ctx->head));
+}
+
+cipher_s *c_info_claim(c_info_s *ctx)
+{
+    size_t num = c_info_num_(ctx);
+    size_t pos = c_index_claim(ctx->__index, ctx->head, num);
+    if (pos < num)
+    {
+        cipher_ctor(ctx->head + pos);
+        return ctx->head + pos;
+    }
+    cipher_s *obj = c_info_push_back(ctx);
+    if (obj)
+    {
+        cipher_ctor(obj);
+    }
+    return obj;
+}
+
+int c_info_erase(c_info_s *ctx, size_t idx)
+{
+    if (idx >= c_info_num_(ctx) || cipher_get_text(ctx->head + idx) == NULL)
+    {
+        return FAILURE;
+    }
+    c_info_mark(ctx, cipher_get_text(ctx->head + idx));
+    c_info_forget(ctx, ctx->head + idx);
+    cipher_dtor(ctx->head + idx);
+    c_index_erase(ctx->__index, ctx->head, c_info_num_(ctx), idx);
+    return SUCCESS;
+}
+
+u64_t c_info_id(const c_info_s *ctx, size_t idx)
+{
+    return c_index_id(ctx->__index, idx);
+}
+
+cipher_s *c_info_get(const c_info_s *ctx, u64_t id)
+{
+    size_t num = c_info_num_(ctx);
+    size_t pos = c_index_get(ctx->__index, ctx->head, num, id);
+    return pos < num ? ctx->head + pos : NULL;
+}
+
+size_t c_info_compact(c_info_s *ctx)
+{
+    size_t num = c_info_num_(ctx);
+    size_t pos = 0;
+    while (pos != num && cipher_get_text(ctx->head + pos))
+    {
+        ++pos;
+    }
+    /* the entries before the first free slot stay where they are */
+    c_index_cut(ctx->__index, ctx->head, pos);
+    c_index_bump(ctx->__index, pos, num);
+    size_t end = pos;
+    for (; pos != num; ++pos)
+    {
+        if (cipher_get_text(ctx->head + pos))
+        {
+            memcpy(ctx->head + end++, ctx->head + pos, sizeof(cipher_s));
+        }
+        else
+        {
+            cipher_dtor(ctx->head + pos);
+        }
+    }
+    ctx->tail = ctx->head + end;
+    /* no free slot is left */
+    c_index_scan(ctx->__index, ctx->head, 0);
+    return num - end;
+}
+
+int c_info_use_arena(c_info_s *ctx)
+{
+    if (ctx->__arena == NULL)
+    {
+        ctx->__arena = c_arena_new();
+    }
+    return ctx->__arena ? SUCCESS : FAILURE;
+}
+
+int c_info_reserve(c_info_s *ctx, size_t num)
+{
+    return c_info_mem_(ctx) < num ? c_info_realloc(ctx, num) : SUCCESS;
+}
+
+cipher_s *c_info_append_n(c_info_s *ctx, size_t n)
+{
+    size_t num = c_info_num_(ctx);
+    if (n && c_info_alloc(ctx, num + n - 1))
+    {
+        return NULL;
+    }
+    cipher_s *obj = ctx->tail;
+    for (size_t i = 0; i != n; ++i)
+    {
+        cipher_ctor(obj + i);
+    }
+    ctx->tail += n;
+    return obj;
+}
+
+int c_info_shrink_to_fit(c_info_s *ctx)
+{
+    size_t num = c_info_num_(ctx);
+    if (c_index_free_num(ctx->__index) > num)
+    {
+        /* drop the stale positions, they would not fit */
+        c_index_scan(ctx->__index, ctx->head, num);
+    }
+    return c_info_mem_(ctx) > num ? c_info_realloc(ctx, num) : SUCCESS;
+}
+
+size_t c_info_search(c_info_s *ctx, cstr_t str, size_t idx)
+{
+    size_t num = c_info_num_(ctx);
+    /* the candidates hold every trigram of str, check that they hold str itself */
+    for (idx = c_index_next(ctx->__index, ctx->head, num, str, idx); idx < num;
+         idx = c_index_next(ctx->__index, ctx->head, num, str, idx + 1))
+    {
+        cstr_t text = cipher_get_text(ctx->head + idx);
+        if (text && strstr(text, str))
+        {
+            return idx;
+        }
+    }
+    return num;
+}
+
+void c_info_mark(c_info_s *ctx, cstr_t text)
+{
+    if (text == NULL)
+    {
+        return;
+    }
+    /* writing every entry is cheaper than looking up most of them */
+    if (c_log_num(ctx->__log) >= c_info_num_(ctx) >> 1)
+    {
+        c_log_all(ctx->__log);
+    }
+    else
+    {
+        c_log_put(ctx->__log, text);
+    }
 }
@@ -0,0 +1,76 @@
+/*!
+ @file log.c
+ @brief change journal
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#include "cipher/a/log.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+void c_log_ctor(c_log_s *ctx)
+{
+    assert(ctx);
+    ctx->__key = NULL;
+    ctx->__num = 0;
+    ctx->__mem = 0;
+    ctx->__all = 0;
+}
+
+void c_log_dtor(c_log_s *ctx)
+{
+    assert(ctx);
+    c_log_drop(ctx);
+    free(ctx->__key);
+    c_log_ctor(ctx);
+}
+
+int c_log_put(c_log_s *ctx, cstr_t key)
+{
+    assert(ctx);
+    assert(key);
+    if (ctx->__all)
+    {
+        return SUCCESS;
+    }
+    if (ctx->__num == ctx->__mem)
+    {
+        size_t mem = ctx->__mem + (ctx->__mem >> 1) + 1;
+        str_t *ptr = (str_t *)realloc(ctx->__key, sizeof(str_t) * mem);
+        if (ptr == NULL)
+        {
+            c_log_all(ctx);
+            return FAILURE;
+        }
+        ctx->__key = ptr;
+        ctx->__mem = mem;
+    }
+    size_t siz = strlen(key) + 1;
+    str_t str = (str_t)malloc(siz);
+    if (str == NULL)
+    {
+        c_log_all(ctx);
+        return FAILURE;
+    }
+    ctx->__key[ctx->__num++] = (str_t)memcpy(str, key, siz);
+    return SUCCESS;
+}
+
+void c_log_all(c_log_s *ctx)
+{
+    assert(ctx);
+    c_log_drop(ctx);
+    ctx->__all = 1;
+}
+
+void c_log_drop(c_log_s *ctx)
+{
+    assert(ctx);
+    while (ctx->__num)
+    {
+        free(ctx->__key[--ctx->__num]);
+    }
+    ctx->__all = 0;
+}
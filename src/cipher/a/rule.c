@@ -103,24 +103,43 @@ void c_rule_drop(c_rule_s *ctx)
 #undef align
 #define align(x) ((sizeof(rule_s) * (x) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
 
+/* resize the memory to exactly mem entries, it holds every entry */
+static int c_rule_realloc(c_rule_s *ctx, size_t mem)
+{
+    size_t n = c_rule_num_(ctx);
+    if (mem == 0)
+    {
+        free(ctx->head);
+        ctx->head = NULL;
+        ctx->tail = NULL;
+        ctx->last = NULL;
+        return SUCCESS;
+    }
+    if (mem < n)
+    {
+        return FAILURE;
+    }
+    rule_s *head = (rule_s *)realloc(ctx->head, align(mem));
+    if (head == NULL)
+    {
+        return FAILURE;
+    }
+    ctx->head = head;
+    ctx->tail = head + n;
+    ctx->last = head + mem;
+    return SUCCESS;
+}
+
 static int c_rule_alloc(c_rule_s *ctx, size_t num)
 {
     size_t mem = c_rule_mem_(ctx);
     if (mem <= num)
     {
-        size_t n = c_rule_num_(ctx);
         do
         {
             mem += (mem >> 1) + 1;
         } while (mem < num);
-        rule_s *head = (rule_s *)realloc(ctx->head, align(mem));
-        if (head == NULL)
-        {
-            return FAILURE;
-        }
-        ctx->head = head;
-        ctx->tail = head + n;
-        ctx->last = head + mem;
+        return c_rule_realloc(ctx, mem);
     }
     return SUCCESS;
 }
@@ -209,3 +228,30 @@ rule_s *c_rule_pop_back(c_rule_s *ctx)
 {
     return ctx->head != ctx->tail ? c_rule_dec_(ctx) : NULL;
 }
+
+int c_rule_reserve(c_rule_s *ctx, size_t num)
+{
+    return c_rule_mem_(ctx) < num ? c_rule_realloc(ctx, num) : SUCCESS;
+}
+
+rule_s *c_rule_append_n(c_rule_s *ctx, size_t n)
+{
+    size_t num = c_rule_num_(ctx);
+    if (n && c_rule_alloc(ctx, num + n - 1))
+    {
+        return NULL;
+    }
+    rule_s *obj = ctx->tail;
+    for (size_t i = 0; i != n; ++i)
+    {
+        rule_ctor(obj + i);
+    }
+    ctx->tail += n;
+    return obj;
+}
+
+int c_rule_shrink_to_fit(c_rule_s *ctx)
+{
+    size_t num = c_rule_num_(ctx);
+    return c_rule_mem_(ctx) > num ? c_rule_realloc(ctx, num) : SUCCESS;
+}
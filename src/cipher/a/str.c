@@ -39,15 +39,35 @@ void str_ctor(str_s *ctx)
 void str_dtor(str_s *ctx)
 {
     assert(ctx);
-    if (ctx->__str)
+    if (!str_sso(ctx) && ctx->__str)
     {
         free(ctx->__str);
-        ctx->__str = NULL;
     }
+    ctx->__str = NULL;
     ctx->__num = 0;
     ctx->__mem = 0;
 }
 
+/* set the length without touching the string */
+static inline void str_num_(str_s *ctx, size_t num)
+{
+    if (str_sso(ctx))
+    {
+        ((unsigned char *)ctx)[sizeof(str_s) - 1] = (unsigned char)(0x80 | num);
+    }
+    else
+    {
+        ctx->__num = num;
+    }
+}
+
+/* an empty string inside the structure */
+static inline void str_sso_(str_s *ctx)
+{
+    memset(ctx, 0, sizeof(str_s));
+    ((unsigned char *)ctx)[sizeof(str_s) - 1] = 0x80;
+}
+
 #if defined(__clang__)
 #pragma GCC diagnostic ignored "-Wcomma"
 #endif /* __clang__ */
@@ -66,18 +86,26 @@ void str_dtor(str_s *ctx)
 int str_init(str_s *ctx, const void *pdata, size_t nbyte)
 {
     assert(ctx);
-    ctx->__num = nbyte;
-    ctx->__mem = nbyte + 1;
-    ctx->__str = (char *)malloc(roundup32(ctx->__mem));
-    if (unlikely(ctx->__str == NULL))
+    if (nbyte < STR_SSO)
     {
-        return 1;
+        str_sso_(ctx);
     }
+    else
+    {
+        ctx->__mem = nbyte + 1;
+        ctx->__str = (char *)malloc(roundup32(ctx->__mem));
+        if (unlikely(ctx->__str == NULL))
+        {
+            return 1;
+        }
+    }
+    char *str = str_val(ctx);
     if (pdata && nbyte)
     {
-        memcpy(ctx->__str, pdata, nbyte);
+        memcpy(str, pdata, nbyte);
     }
-    ctx->__str[ctx->__num] = 0;
+    str_num_(ctx, nbyte);
+    str[nbyte] = 0;
     return 0;
 }
 
@@ -85,6 +113,11 @@ int str_copy(str_s *ctx, const str_s *obj)
 {
     assert(ctx);
     assert(obj);
+    if (str_sso(obj))
+    {
+        memcpy(ctx, obj, sizeof(str_s));
+        return 0;
+    }
     return str_init(ctx, obj->__str, obj->__num);
 }
 
@@ -100,12 +133,22 @@ str_s *str_move(str_s *ctx, str_s *obj)
 char *str_exit(str_s *ctx)
 {
     assert(ctx);
-    char *str = ctx->__str;
-    if (ctx->__str)
+    size_t num = str_len(ctx);
+    char *str = str_val(ctx);
+    if (str_sso(ctx))
     {
-        ctx->__str[ctx->__num] = 0;
-        ctx->__str = NULL;
+        str = (char *)malloc(num + 1);
+        if (unlikely(str == NULL))
+        {
+            return NULL;
+        }
+        memcpy(str, ctx, num);
     }
+    if (str)
+    {
+        str[num] = 0;
+    }
+    ctx->__str = NULL;
     ctx->__mem = 0;
     ctx->__num = 0;
     return str;
@@ -116,25 +159,52 @@ int str_cmp(const str_s *lhs, const str_s *rhs)
     assert(lhs);
     assert(rhs);
     int ok = 0;
-    if (lhs->__str && rhs->__str)
+    size_t lnum = str_len(lhs);
+    size_t rnum = str_len(rhs);
+    if (str_val(lhs) && str_val(rhs))
     {
-        size_t num = lhs->__num < rhs->__num ? lhs->__num : rhs->__num;
-        ok = memcmp(lhs->__str, rhs->__str, num);
+        size_t num = lnum < rnum ? lnum : rnum;
+        ok = memcmp(str_val(lhs), str_val(rhs), num);
     }
     if (ok)
     {
         return ok;
     }
-    if (lhs->__num == rhs->__num)
+    if (lnum == rnum)
     {
         return 0;
     }
-    return lhs->__num < rhs->__num ? -1 : 1;
+    return lnum < rnum ? -1 : 1;
 }
 
 int str_resize_(str_s *ctx, size_t mem)
 {
     assert(ctx);
+    if (str_sso(ctx))
+    {
+        if (mem <= STR_SSO)
+        {
+            return 0;
+        }
+        /* the string outgrows the structure */
+        size_t num = str_len(ctx);
+        char *str = (char *)malloc(roundup32(mem));
+        if (unlikely(str == NULL))
+        {
+            return 1;
+        }
+        memcpy(str, ctx, num);
+        str[num] = 0;
+        ctx->__str = str;
+        ctx->__num = num;
+        ctx->__mem = mem;
+        return 0;
+    }
+    if (ctx->__str == NULL && mem && mem <= STR_SSO)
+    {
+        str_sso_(ctx);
+        return 0;
+    }
     char *str = (char *)realloc(ctx->__str, roundup32(mem));
     if (unlikely(!str && mem))
     {
@@ -148,17 +218,19 @@ int str_resize_(str_s *ctx, size_t mem)
 int str_resize(str_s *ctx, size_t mem)
 {
     assert(ctx);
-    return ctx->__mem < mem ? str_resize_(ctx, mem) : 0;
+    return str_mem(ctx) < mem ? str_resize_(ctx, mem) : 0;
 }
 
 int str_putc_(str_s *ctx, int c)
 {
     assert(ctx);
-    if (unlikely(str_resize(ctx, ctx->__num + 1)))
+    size_t num = str_len(ctx);
+    if (unlikely(str_resize(ctx, num + 1)))
     {
         return EOF;
     }
-    ctx->__str[ctx->__num++] = (char)c;
+    str_val(ctx)[num] = (char)c;
+    str_num_(ctx, num + 1);
     return c;
 }
 
@@ -169,12 +241,15 @@ int str_putc(str_s *ctx, int c)
     {
         return str_putc_(ctx, c);
     }
-    if (unlikely(str_resize(ctx, ctx->__num + 2)))
+    size_t num = str_len(ctx);
+    if (unlikely(str_resize(ctx, num + 2)))
     {
         return EOF;
     }
-    ctx->__str[ctx->__num++] = (char)c;
-    ctx->__str[ctx->__num] = 0;
+    char *str = str_val(ctx);
+    str[num++] = (char)c;
+    str[num] = 0;
+    str_num_(ctx, num);
     return c;
 }
 
@@ -183,12 +258,13 @@ int str_putn_(str_s *ctx, const void *pdata, size_t nbyte)
     assert(ctx);
     if (pdata && nbyte)
     {
-        if (unlikely(str_resize(ctx, ctx->__num + nbyte)))
+        size_t num = str_len(ctx);
+        if (unlikely(str_resize(ctx, num + nbyte)))
         {
             return 1;
         }
-        memcpy(ctx->__str + ctx->__num, pdata, nbyte);
-        ctx->__num += nbyte;
+        memcpy(str_val(ctx) + num, pdata, nbyte);
+        str_num_(ctx, num + nbyte);
     }
     return 0;
 }
@@ -198,16 +274,19 @@ int str_putn(str_s *ctx, const void *pdata, size_t nbyte)
     assert(ctx);
     if (pdata)
     {
-        if (unlikely(str_resize(ctx, ctx->__num + nbyte + 1)))
+        size_t num = str_len(ctx);
+        if (unlikely(str_resize(ctx, num + nbyte + 1)))
         {
             return 1;
         }
+        char *str = str_val(ctx);
         if (nbyte)
         {
-            memcpy(ctx->__str + ctx->__num, pdata, nbyte);
-            ctx->__num += nbyte;
+            memcpy(str + num, pdata, nbyte);
+            num += nbyte;
         }
-        ctx->__str[ctx->__num] = 0;
+        str[num] = 0;
+        str_num_(ctx, num);
     }
     return 0;
 }
@@ -225,22 +304,23 @@ int str_vprintf(str_s *ctx, const char *fmt, va_list va)
     assert(fmt);
     va_list ap;
     va_copy(ap, va);
-    char *str = ctx->__str ? ctx->__str + ctx->__num : NULL;
-    int ret = vsnprintf(str, ctx->__mem - ctx->__num, fmt, ap);
+    size_t num = str_len(ctx);
+    char *str = str_val(ctx) ? str_val(ctx) + num : NULL;
+    int ret = vsnprintf(str, str_mem(ctx) - num, fmt, ap);
     va_end(ap);
     size_t size = (size_t)ret + 1;
-    if (ctx->__mem - ctx->__num < size)
+    if (str_mem(ctx) - num < size)
     {
-        if (unlikely(str_resize_(ctx, ctx->__num + size)))
+        if (unlikely(str_resize_(ctx, num + size)))
         {
             return EOF;
         }
         va_copy(ap, va);
-        str = ctx->__str + ctx->__num;
-        ret = vsnprintf(str, ctx->__mem - ctx->__num, fmt, ap);
+        str = str_val(ctx) + num;
+        ret = vsnprintf(str, str_mem(ctx) - num, fmt, ap);
         va_end(ap);
     }
-    ctx->__num += (size_t)ret;
+    str_num_(ctx, num + (size_t)ret);
     return ret;
 }
 
@@ -18,6 +18,11 @@ static inline size_t c_word_mem_(const c_word_s *ctx)
     return (size_t)(ctx->last - ctx->head);
 }
 
+static cstr_t c_word_text_(const void *head, size_t pos)
+{
+    return str_val((const str_s *)head + pos);
+}
+
 c_word_s *c_word_new(void)
 {
     c_word_s *ctx = (c_word_s *)malloc(sizeof(c_word_s));
@@ -42,6 +47,8 @@ void c_word_ctor(c_word_s *ctx)
     ctx->head = NULL;
     ctx->tail = NULL;
     ctx->last = NULL;
+    c_index_ctor(ctx->__index, c_word_text_);
+    c_log_ctor(ctx->__log);
 }
 
 void c_word_dtor(c_word_s *ctx)
@@ -54,15 +61,21 @@ void c_word_dtor(c_word_s *ctx)
     }
     ctx->tail = NULL;
     ctx->last = NULL;
+    c_index_dtor(ctx->__index);
+    c_log_dtor(ctx->__log);
 }
 
 int c_word_copy(c_word_s *ctx, const c_word_s *obj)
 {
     size_t num = c_word_num_(obj);
     size_t mem = c_word_mem_(obj);
+    c_word_ctor(ctx);
     ctx->head = (str_s *)malloc(sizeof(str_s) * mem);
-    if (ctx->head == NULL)
+    if (ctx->head == NULL || c_index_copy(ctx->__index, obj->__index, mem))
     {
+        /* there is no entry to destruct yet */
+        ctx->tail = ctx->head;
+        c_word_dtor(ctx);
         return FAILURE;
     }
     ctx->tail = ctx->head + num;
@@ -73,18 +86,23 @@ int c_word_copy(c_word_s *ctx, const c_word_s *obj)
     {
         str_copy(dst, src);
     }
+    c_index_scan(ctx->__index, ctx->head, num);
     return SUCCESS;
 }
 
 c_word_s *c_word_move(c_word_s *ctx, c_word_s *obj)
 {
     memcpy(ctx, obj, sizeof(c_word_s));
-    memset(obj, 000, sizeof(c_word_s));
+    /* obj is left empty, and ready for use */
+    c_word_ctor(obj);
     return ctx;
 }
 
 void c_word_drop(c_word_s *ctx)
 {
+    size_t num = c_word_num_(ctx);
+    c_index_clear(ctx->__index);
+    c_index_bump(ctx->__index, 0, num);
     while (ctx->head != ctx->tail)
     {
         --ctx->tail;
@@ -95,24 +113,53 @@ void c_word_drop(c_word_s *ctx)
 #undef align
 #define align(x) ((sizeof(str_s) * (x) + sizeof(void *) - 1) & ~(sizeof(void *) - 1))
 
+/* resize the memory to exactly mem entries, it holds every entry */
+static int c_word_realloc(c_word_s *ctx, size_t mem)
+{
+    size_t n = c_word_num_(ctx);
+    size_t old = c_word_mem_(ctx);
+    if (mem == 0)
+    {
+        free(ctx->head);
+        ctx->head = NULL;
+        ctx->tail = NULL;
+        ctx->last = NULL;
+        return c_index_alloc(ctx->__index, old, 0);
+    }
+    if (mem < n)
+    {
+        return FAILURE;
+    }
+    /* the side arrays are never shorter than the entries, even on failure */
+    if (old < mem && c_index_alloc(ctx->__index, old, mem))
+    {
+        return FAILURE;
+    }
+    str_s *head = (str_s *)realloc(ctx->head, align(mem));
+    if (head == NULL)
+    {
+        return FAILURE;
+    }
+    ctx->head = head;
+    ctx->tail = head + n;
+    ctx->last = head + mem;
+    if (mem < old)
+    {
+        c_index_alloc(ctx->__index, old, mem);
+    }
+    return SUCCESS;
+}
+
 static int c_word_alloc(c_word_s *ctx, size_t num)
 {
     size_t mem = c_word_mem_(ctx);
     if (mem <= num)
     {
-        size_t n = c_word_num_(ctx);
         do
         {
             mem += (mem >> 1) + 1;
         } while (mem < num);
-        str_s *head = (str_s *)realloc(ctx->head, align(mem));
-        if (head == NULL)
-        {
-            return FAILURE;
-        }
-        ctx->head = head;
-        ctx->tail = head + n;
-        ctx->last = head + mem;
+        return c_word_realloc(ctx, mem);
     }
     return SUCCESS;
 }
@@ -132,9 +179,12 @@ int c_word_swap(c_word_s *ctx, size_t lhs, size_t rhs)
     {
         return FAILURE;
     }
+    c_index_swap(ctx->__index, ctx->head, lhs, rhs);
     memcpy(ctx->head + num, ctx->head + lhs, sizeof(str_s));
     memcpy(ctx->head + lhs, ctx->head + rhs, sizeof(str_s));
     memcpy(ctx->head + rhs, ctx->head + num, sizeof(str_s));
+    /* the table keeps the order of the words, the first is the default */
+    c_log_all(ctx->__log);
     return SUCCESS;
 }
 
@@ -147,11 +197,17 @@ str_s *c_word_insert(c_word_s *ctx, size_t idx)
     }
     if (idx < num)
     {
+        c_index_cut(ctx->__index, ctx->head, idx);
         str_s *ptr = ctx->tail;
         str_s *src = ctx->head + idx + 0;
         str_s *dst = ctx->head + idx + 1;
         memmove(dst, src, sizeof(str_s) * (size_t)(ptr - src));
         c_word_inc_(ctx);
+        c_index_bump(ctx->__index, idx, num + 1);
+        if (c_index_free_num(ctx->__index))
+        {
+            c_index_scan(ctx->__index, ctx->head, num + 1);
+        }
         return src;
     }
     return c_word_inc_(ctx);
@@ -181,15 +237,21 @@ str_s *c_word_remove(c_word_s *ctx, size_t idx)
         {
             return NULL;
         }
+        c_index_cut(ctx->__index, ctx->head, idx);
         str_s *ptr = ctx->tail;
         str_s *dst = ctx->head + idx + 0;
         str_s *src = ctx->head + idx + 1;
         memcpy(ptr, dst, sizeof(str_s));
         memmove(dst, src, sizeof(str_s) * (size_t)(ptr - src));
         c_word_dec_(ctx);
+        c_index_bump(ctx->__index, idx, num);
+        if (c_index_free_num(ctx->__index))
+        {
+            c_index_scan(ctx->__index, ctx->head, num - 1);
+        }
         return ptr;
     }
-    return ctx->head != ctx->tail ? c_word_inc_(ctx) : NULL;
+    return c_word_pop_back(ctx);
 }
 
 str_s *c_word_pop_fore(c_word_s *ctx)
@@ -199,5 +261,178 @@ str_s *c_word_pop_fore(c_word_s *ctx)
 
 str_s *c_word_pop_back(c_word_s *ctx)
 {
-    return ctx->head != ctx->tail ? c_word_dec_(ctx) : NULL;
+    if (ctx->head == ctx->tail)
+    {
+        return NULL;
+    }
+    /* a free slot that is popped stays in __free, c_word_claim skips it */
+    size_t num = c_word_num_(ctx);
+    c_index_cut(ctx->__index, ctx->head, num - 1);
+    c_index_bump(ctx->__index, num - 1, num);
+    return c_word_dec_(ctx);
+}
+
+str_s *c_word_find(c_word_s *ctx, cstr_t text)
+{
+    size_t num = c_word_num_(ctx);
+    size_t pos = c_index_find(ctx->__index, ctx->head, num, text);
+    return pos < num ? ctx->head + pos : NULL;
+}
+
+void c_word_forget(c_word_s *ctx, const str_s *obj)
+{
+    c_index_forget(ctx->__index, ctx->head, (size_t)(obj - ctx->head));
+}
+
+int c_word_reindex(c_word_s *ctx)
+{
+    return c_index_reindex(ctx->__index, ctx->head, c_word_num_(ctx));
+}
+
+int c_word_remember(c_word_s *ctx, const str_s *obj)
+{
+    return c_index_remember(ctx->__index, ctx->head, (size_t)(obj - ctx->head));
+}
+
+str_s *c_word_claim(c_word_s *ctx)
+{
+    size_t num = c_word_num_(ctx);
+    size_t pos = c_index_claim(ctx->__index, ctx->head, num);
+    if (pos < num)
+    {
+        str_ctor(ctx->head + pos);
+        return ctx->head + pos;
+    }
+    str_s *obj = c_word_push_back(ctx);
+    if (obj)
+    {
+        str_ctor(obj);
+    }
+    return obj;
+}
+
+void c_word_unclaim(c_word_s *ctx, str_s *obj)
+{
+    c_word_forget(ctx, obj);
+    str_dtor(obj);
+    c_index_erase(ctx->__index, ctx->head, c_word_num_(ctx), (size_t)(obj - ctx->head));
+}
+
+int c_word_erase(c_word_s *ctx, size_t idx)
+{
+    if (idx >= c_word_num_(ctx) || str_val(ctx->head + idx) == NULL)
+    {
+        return FAILURE;
+    }
+    c_word_mark(ctx, str_val(ctx->head + idx));
+    c_word_forget(ctx, ctx->head + idx);
+    str_dtor(ctx->head + idx);
+    c_index_erase(ctx->__index, ctx->head, c_word_num_(ctx), idx);
+    return SUCCESS;
+}
+
+u64_t c_word_id(const c_word_s *ctx, size_t idx)
+{
+    return c_index_id(ctx->__index, idx);
+}
+
+str_s *c_word_get(const c_word_s *ctx, u64_t id)
+{
+    size_t num = c_word_num_(ctx);
+    size_t pos = c_index_get(ctx->__index, ctx->head, num, id);
+    return pos < num ? ctx->head + pos : NULL;
+}
+
+size_t c_word_compact(c_word_s *ctx)
+{
+    size_t num = c_word_num_(ctx);
+    size_t pos = 0;
+    while (pos != num && str_val(ctx->head + pos))
+    {
+        ++pos;
+    }
+    /* the entries before the first free slot stay where they are */
+    c_index_cut(ctx->__index, ctx->head, pos);
+    c_index_bump(ctx->__index, pos, num);
+    size_t end = pos;
+    for (; pos != num; ++pos)
+    {
+        if (str_val(ctx->head + pos))
+        {
+            memcpy(ctx->head + end++, ctx->head + pos, sizeof(str_s));
+        }
+        else
+        {
+            str_dtor(ctx->head + pos);
+        }
+    }
+    ctx->tail = ctx->head + end;
+    /* no free slot is left */
+    c_index_scan(ctx->__index, ctx->head, 0);
+    return num - end;
+}
+
+int c_word_reserve(c_word_s *ctx, size_t num)
+{
+    return c_word_mem_(ctx) < num ? c_word_realloc(ctx, num) : SUCCESS;
+}
+
+str_s *c_word_append_n(c_word_s *ctx, size_t n)
+{
+    size_t num = c_word_num_(ctx);
+    if (n && c_word_alloc(ctx, num + n - 1))
+    {
+        return NULL;
+    }
+    str_s *obj = ctx->tail;
+    for (size_t i = 0; i != n; ++i)
+    {
+        str_ctor(obj + i);
+    }
+    ctx->tail += n;
+    return obj;
+}
+
+int c_word_shrink_to_fit(c_word_s *ctx)
+{
+    size_t num = c_word_num_(ctx);
+    if (c_index_free_num(ctx->__index) > num)
+    {
+        /* drop the stale positions, they would not fit */
+        c_index_scan(ctx->__index, ctx->head, num);
+    }
+    return c_word_mem_(ctx) > num ? c_word_realloc(ctx, num) : SUCCESS;
+}
+
+size_t c_word_search(c_word_s *ctx, cstr_t str, size_t idx)
+{
+    size_t num = c_word_num_(ctx);
+    /* the candidates hold every trigram of str, check that they hold str itself */
+    for (idx = c_index_next(ctx->__index, ctx->head, num, str, idx); idx < num;
+         idx = c_index_next(ctx->__index, ctx->head, num, str, idx + 1))
+    {
+        cstr_t text = str_val(ctx->head + idx);
+        if (text && *text && strstr(text, str))
+        {
+            return idx;
+        }
+    }
+    return num;
+}
+
+void c_word_mark(c_word_s *ctx, cstr_t word)
+{
+    if (word == NULL)
+    {
+        return;
+    }
+    /* writing every entry is cheaper than looking up most of them */
+    if (c_log_num(ctx->__log) >= c_word_num_(ctx) >> 1)
+    {
+        c_log_all(ctx->__log);
+    }
+    else
+    {
+        c_log_put(ctx->__log, word);
+    }
 }
@@ -8,119 +8,137 @@
 
 #include "cksum/util/hmac.h"
 #include "cksum/util/conv.h"
+#include "cksum/util/state.h"
+#include "cksum/pbkdf2.h"
 
 #include <assert.h>
 #include <string.h>
 #include <ctype.h>
 
-static const hash_s *cipher_hash(cstr_t text)
+/*
+ The interned names, they are stored in one array so that a name
+ set through cipher_set_hash resolves by its address alone.
+*/
+static const char cipher_hash_names[][8] = {
+    "MD5",
+    "SHA1",
+    "SHA224",
+    "SHA256",
+    "SHA384",
+    "SHA512",
+    "SHA3",
+    "BLAKE2S",
+    "BLAKE2B",
+};
+static const hash_s *const cipher_hashes[] = {
+    &hash_md5,
+    &hash_sha1,
+    &hash_sha224,
+    &hash_sha256,
+    &hash_sha384,
+    &hash_sha512,
+    &hash_sha3_512,
+    &hash_blake2s_256,
+    &hash_blake2b_512,
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/* the accepted spellings and the interned names they stand for */
+static const struct
 {
-    if (text == 0)
-    {
-        return &hash_md5;
-    }
-    switch (*text)
-    {
-    case 'm':
-    {
-        if (strcmp(text, "md5") == 0)
-        {
-            return &hash_md5;
-        }
-    }
-    break;
-    case 'M':
+    cstr_t name;
+    unsigned int hash;
+} cipher_hash_keys[] = {
+    {"MD5", 0},
+    {"SHA1", 1},
+    {"SHA224", 2},
+    {"SHA256", 3},
+    {"SHA384", 4},
+    {"SHA512", 5},
+    {"SHA3", 6},
+    {"BLAKE2S", 7},
+    {"BLAKE2B", 8},
+    {"SHA-1", 1},
+    {"SHA-224", 2},
+    {"SHA-256", 3},
+    {"SHA-384", 4},
+    {"SHA-512", 5},
+    {"SHA3-512", 6},
+    {"BLAKE2S-256", 7},
+    {"BLAKE2B-512", 8},
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+/*
+ A perfect hash of the upper case keys, the seed is chosen so that every
+ key has a slot of its own. A slot holds the index of its key plus one.
+*/
+#define CIPHER_HASH_SEED 0x7E6
+static const byte_t cipher_hash_slots[0x20] = {
+    0, 11, 0, 0, 6, 13, 5, 14, 0, 0, 1, 0, 0, 0, 16, 2,
+    7, 12, 15, 0, 0, 10, 0, 3, 4, 0, 17, 0, 0, 8, 0, 9};
+
+/* the index of the interned name, or -1 */
+static int cipher_hash_index(cstr_t name)
+{
+    uint32_t x = CIPHER_HASH_SEED;
+    for (cstr_t s = name; *s; ++s)
     {
-        if (strcmp(text, "MD5") == 0)
-        {
-            return &hash_md5;
-        }
+        x ^= (byte_t)toupper((byte_t)*s);
+        x *= 0x01000193;
     }
-    break;
-    case 's':
+    unsigned int slot = cipher_hash_slots[x >> 27];
+    if (slot == 0)
     {
-        if (strcmp(text, "sha1") == 0)
-        {
-            return &hash_sha1;
-        }
-        if (strcmp(text, "sha256") == 0)
-        {
-            return &hash_sha256;
-        }
-        if (strcmp(text, "sha224") == 0)
-        {
-            return &hash_sha224;
-        }
-        if (strcmp(text, "sha512") == 0)
-        {
-            return &hash_sha512;
-        }
-        if (strcmp(text, "sha384") == 0)
-        {
-            return &hash_sha384;
-        }
-        if (strcmp(text, "sha3") == 0)
-        {
-            return &hash_sha3_512;
-        }
+        return -1;
     }
-    break;
-    case 'S':
+    cstr_t key = cipher_hash_keys[slot - 1].name;
+    for (cstr_t s = name; *key || *s; ++key, ++s)
     {
-        if (strcmp(text, "SHA1") == 0)
-        {
-            return &hash_sha1;
-        }
-        if (strcmp(text, "SHA256") == 0)
-        {
-            return &hash_sha256;
-        }
-        if (strcmp(text, "SHA224") == 0)
-        {
-            return &hash_sha224;
-        }
-        if (strcmp(text, "SHA512") == 0)
-        {
-            return &hash_sha512;
-        }
-        if (strcmp(text, "SHA384") == 0)
-        {
-            return &hash_sha384;
-        }
-        if (strcmp(text, "SHA3") == 0)
+        if (*key != toupper((byte_t)*s))
         {
-            return &hash_sha3_512;
+            return -1;
         }
     }
-    break;
-    case 'b':
+    return (int)cipher_hash_keys[slot - 1].hash;
+}
+
+int cipher_hash_id(cstr_t name)
+{
+    if (name == 0)
     {
-        if (strcmp(text, "blake2s") == 0)
-        {
-            return &hash_blake2s_256;
-        }
-        if (strcmp(text, "blake2b") == 0)
-        {
-            return &hash_blake2b_512;
-        }
+        return -1;
     }
-    break;
-    case 'B':
+    uintptr_t off = (uintptr_t)name - (uintptr_t)cipher_hash_names;
+    if (off < sizeof(cipher_hash_names))
     {
-        if (strcmp(text, "BLAKE2S") == 0)
-        {
-            return &hash_blake2s_256;
-        }
-        if (strcmp(text, "BLAKE2B") == 0)
-        {
-            return &hash_blake2b_512;
-        }
-    }
-    break;
-    default:
-        break;
+        return (int)(off / sizeof(*cipher_hash_names));
     }
-    return &hash_md5;
+    return cipher_hash_index(name);
+}
+
+cstr_t cipher_hash_name(unsigned int id)
+{
+    return id < sizeof(cipher_hash_names) / sizeof(*cipher_hash_names) ? cipher_hash_names[id] : 0;
+}
+
+const hash_s *cipher_hash(cstr_t name)
+{
+    int idx = cipher_hash_id(name);
+    return idx < 0 ? 0 : cipher_hashes[idx];
+}
+
+/* an entry without a hash name uses MD5 */
+static inline const hash_s *cipher_hash_(const cipher_s *ctx)
+{
+    return ctx->hash ? cipher_hash(ctx->hash) : &hash_md5;
 }
 
 static str_t hmac(cptr_t key, size_t keysiz, cptr_t msg, size_t msgsiz, const hash_s *hash, vptr_t out)
@@ -145,13 +163,17 @@ int cipher_v1(const cipher_s *ctx, cstr_t word, str_t *out)
 
     if (ctx->text == 0)
     {
-        return -3;
+        return INVALID;
     }
     if (ctx->type == CIPHER_OTHER && ctx->misc == 0)
     {
         return -2;
     }
-    const hash_s *hash = cipher_hash(ctx->hash);
+    const hash_s *hash = cipher_hash_(ctx);
+    if (hash == 0)
+    {
+        return NOTFOUND;
+    }
     uint_t lword = (uint_t)strlen(word);
     uint_t ltext = (uint_t)strlen(ctx->text);
     if ((ctx->size == 0) || (lword == 0) || (ltext == 0))
@@ -168,10 +190,16 @@ int cipher_v1(const cipher_s *ctx, cstr_t word, str_t *out)
     str_t buf0 = hmac("kise", 4, msg, outsiz, hash, 0);
     str_t buf1 = hmac("snow", 4, msg, outsiz, hash, 0);
 
+    /* the values of the hexadecimal characters, converted in bulk */
+    byte_t hex0[HASH_BUFSIZ << 1];
+    byte_t hex1[HASH_BUFSIZ << 1];
+    hex_xdigits(buf0, length, hex0);
+    hex_xdigits(buf1, length, hex1);
+
     *out = (str_t)calloc(length + 1, sizeof(char));
     for (uint_t i = 0; i != length; ++i)
     {
-        int x = xdigit(buf0[i]) + xdigit(buf1[i]);
+        int x = hex0[i] + hex1[i];
         msg[i] = (byte_t)x;
 
         switch (ctx->type)
@@ -260,6 +288,10 @@ static struct
     uint_t l1;
     uint_t l2;
     uint_t l3;
+    /* the HMAC key states of the rules under each hash, derived by cipher_v2_init or imported */
+    pbkdf2_s key[sizeof(cipher_hashes) / sizeof(*cipher_hashes)][4];
+    /* one bit for each hash whose key states are there, only set up while no cipher_v2 runs */
+    uint_t keys;
     /* character table */
     const char ch[CH];
 } stat[1] = {
@@ -272,6 +304,7 @@ static struct
         .l1 = 0,
         .l2 = 0,
         .l3 = 0,
+        .keys = 0,
         .ch = {
             /* clang-format off */
             'a', 'A', 'b', 'B', 'c', 'C', 'd', 'D', 'e', 'E', 'f', 'F', 'g', 'G', 'h',
@@ -287,7 +320,16 @@ static struct
 #pragma GCC diagnostic pop
 #endif /* __GNUC__ || __clang__ */
 
-void cipher_v2_init(cptr_t s0, cptr_t s1, cptr_t s2, cptr_t s3)
+static void cipher_v2_derive_(unsigned int id, pbkdf2_s key[4])
+{
+    const hash_s *hash = cipher_hashes[id];
+    pbkdf2_init(key + 0, hash, stat->s0, stat->l0);
+    pbkdf2_init(key + 1, hash, stat->s1, stat->l1);
+    pbkdf2_init(key + 2, hash, stat->s2, stat->l2);
+    pbkdf2_init(key + 3, hash, stat->s3, stat->l3);
+}
+
+void cipher_v2_rule(cptr_t s0, cptr_t s1, cptr_t s2, cptr_t s3)
 {
     /* Set the rules */
     stat->s0 = (cstr_t)s0;
@@ -299,6 +341,116 @@ void cipher_v2_init(cptr_t s0, cptr_t s1, cptr_t s2, cptr_t s3)
     stat->l1 = s1 ? (uint_t)strlen(stat->s1) : 0;
     stat->l2 = s2 ? (uint_t)strlen(stat->s2) : 0;
     stat->l3 = s3 ? (uint_t)strlen(stat->s3) : 0;
+    /* the key states of the old rules are stale */
+    stat->keys = 0;
+}
+
+void cipher_v2_init(cptr_t s0, cptr_t s1, cptr_t s2, cptr_t s3)
+{
+    cipher_v2_rule(s0, s1, s2, s3);
+    /* the key states are derived here, so that cipher_v2 only reads them */
+    for (unsigned int id = 0; id != sizeof(cipher_hashes) / sizeof(*cipher_hashes); ++id)
+    {
+        cipher_v2_derive_(id, stat->key[id]);
+        stat->keys |= 1U << id;
+    }
+}
+
+/* the key states of the rules under the hash of id, derived into key when they are not there */
+static const pbkdf2_s *cipher_v2_key_(unsigned int id, pbkdf2_s key[4])
+{
+    if (stat->keys & (1U << id))
+    {
+        return stat->key[id];
+    }
+    cipher_v2_derive_(id, key);
+    return key;
+}
+
+/* the same digest as hmac with the rule as the key, from the key state of the rule */
+static str_t cipher_v2_hmac_(const pbkdf2_s *key, cptr_t msg, size_t msgsiz)
+{
+    const hash_s *hash = key->__hash;
+    byte_t buf[HMAC_BUFSIZ];
+    hash_u ctx[1];
+
+    memcpy(ctx, key->__inner, sizeof(hash_u));
+    hash->proc(ctx, msg, msgsiz);
+    hash->done(ctx, buf);
+    memcpy(ctx, key->__outer, sizeof(hash_u));
+    hash->proc(ctx, buf, hash->outsiz);
+    hash->done(ctx, buf);
+
+    return (str_t)digest_lower(buf, hash->outsiz, 0);
+}
+
+/*
+ A blob is the inner and the outer state of each rule in turn, as blobs of
+ hash_state_export. The size of such a blob is kept in its head.
+*/
+int cipher_v2_export(cstr_t hash, void *out, size_t *siz)
+{
+    assert(siz);
+    assert(!*siz || out);
+
+    int id = hash ? cipher_hash_id(hash) : 0;
+    if (id < 0)
+    {
+        return NOTFOUND;
+    }
+    pbkdf2_s tmp[4];
+    const pbkdf2_s *key = cipher_v2_key_((unsigned int)id, tmp);
+    byte_t *p = (byte_t *)out;
+    size_t num = 0;
+    int ret = SUCCESS;
+    for (unsigned int i = 0; i != 8; ++i)
+    {
+        const pbkdf2_s *it = key + (i >> 1);
+        size_t n = ret ? 0 : *siz - num;
+        /* the hashes are builtin ones, so a state only fails to fit, and the sizes are summed up */
+        if (hash_state_export(it->__hash, (i & 1) ? it->__outer : it->__inner, ret ? 0 : p + num, &n))
+        {
+            ret = OVERFLOW;
+        }
+        num += n;
+    }
+    *siz = num;
+
+    return ret;
+}
+
+int cipher_v2_import(cstr_t hash, const void *pdata, size_t nbyte)
+{
+    assert(!nbyte || pdata);
+
+    int id = hash ? cipher_hash_id(hash) : 0;
+    if (id < 0)
+    {
+        return NOTFOUND;
+    }
+    pbkdf2_s key[4];
+    const byte_t *p = (const byte_t *)pdata;
+    for (unsigned int i = 0; i != 8; ++i)
+    {
+        pbkdf2_s *it = key + (i >> 1);
+        size_t n = nbyte < 8 ? 0 : 8 + (size_t)(p[6] | p[7] << 8);
+        if (n == 0 || n > nbyte ||
+            hash_state_import(cipher_hashes[id], (i & 1) ? it->__outer : it->__inner, p, n))
+        {
+            return INVALID;
+        }
+        it->__hash = cipher_hashes[id];
+        nbyte -= n;
+        p += n;
+    }
+    if (nbyte)
+    {
+        return INVALID;
+    }
+    memcpy(stat->key[id], key, sizeof(key));
+    stat->keys |= 1U << (unsigned int)id;
+
+    return SUCCESS;
 }
 
 int cipher_v2(const cipher_s *ctx, cstr_t word, str_t *out)
@@ -309,13 +461,18 @@ int cipher_v2(const cipher_s *ctx, cstr_t word, str_t *out)
 
     if (ctx->text == 0)
     {
-        return -3;
+        return INVALID;
     }
     if (ctx->type == CIPHER_OTHER && ctx->misc == 0)
     {
         return -2;
     }
-    const hash_s *hash = cipher_hash(ctx->hash);
+    int id = ctx->hash ? cipher_hash_id(ctx->hash) : 0;
+    if (id < 0)
+    {
+        return NOTFOUND;
+    }
+    const hash_s *hash = cipher_hashes[id];
     uint_t lword = (uint_t)strlen(word);
     uint_t ltext = (uint_t)strlen(ctx->text);
     if ((ctx->size == 0) || (lword == 0) || (ltext == 0))
@@ -329,15 +486,26 @@ int cipher_v2(const cipher_s *ctx, cstr_t word, str_t *out)
     uint_t length = ctx->size < outsiz ? ctx->size : outsiz;
     byte_t *msg = (byte_t *)hmac(ctx->text, ltext, word, lword, hash, 0);
 
-    str_t buf0 = hmac(stat->s0, stat->l0, msg, outsiz, hash, 0);
-    str_t buf1 = hmac(stat->s1, stat->l1, msg, outsiz, hash, 0);
-    str_t buf2 = hmac(stat->s2, stat->l2, msg, outsiz, hash, 0);
-    str_t buf3 = hmac(stat->s3, stat->l3, msg, outsiz, hash, 0);
+    pbkdf2_s tmp[4];
+    const pbkdf2_s *key = cipher_v2_key_((unsigned int)id, tmp);
+    str_t buf0 = cipher_v2_hmac_(key + 0, msg, outsiz);
+    str_t buf1 = cipher_v2_hmac_(key + 1, msg, outsiz);
+    str_t buf2 = cipher_v2_hmac_(key + 2, msg, outsiz);
+    str_t buf3 = cipher_v2_hmac_(key + 3, msg, outsiz);
+
+    byte_t hex0[HASH_BUFSIZ << 1];
+    byte_t hex1[HASH_BUFSIZ << 1];
+    byte_t hex2[HASH_BUFSIZ << 1];
+    byte_t hex3[HASH_BUFSIZ << 1];
+    hex_xdigits(buf0, length, hex0);
+    hex_xdigits(buf1, length, hex1);
+    hex_xdigits(buf2, length, hex2);
+    hex_xdigits(buf3, length, hex3);
 
     *out = (str_t)calloc(length + 1, sizeof(char));
     for (uint_t i = 0; i != length; ++i)
     {
-        int x = xdigit(buf0[i]) + xdigit(buf1[i]) + xdigit(buf2[i]) + xdigit(buf3[i]);
+        int x = hex0[i] + hex1[i] + hex2[i] + hex3[i];
         msg[i] = (byte_t)x;
 
         switch (ctx->type)
@@ -417,6 +585,11 @@ int cipher_v2(const cipher_s *ctx, cstr_t word, str_t *out)
     return 0;
 }
 
+#define CIPHER_REF_HINT (1 << 0)
+#define CIPHER_REF_MISC (1 << 1)
+#define CIPHER_REF_TEXT (1 << 2)
+#define CIPHER_REF_HASH (1 << 3)
+
 void cipher_ctor(cipher_s *ctx)
 {
     assert(ctx);
@@ -426,17 +599,23 @@ void cipher_ctor(cipher_s *ctx)
     ctx->hash = 0;
     ctx->type = CIPHER_EMAIL;
     ctx->size = 16;
+    ctx->__ref = 0;
 }
 
 void cipher_dtor(cipher_s *ctx)
 {
     assert(ctx);
-    ctx->hint ? ((void)(free(ctx->hint)), ctx->hint = 0) : 0;
-    ctx->misc ? ((void)(free(ctx->misc)), ctx->misc = 0) : 0;
-    ctx->text ? ((void)(free(ctx->text)), ctx->text = 0) : 0;
-    ctx->hash ? ((void)(free(ctx->hash)), ctx->hash = 0) : 0;
+    (ctx->hint && !(ctx->__ref & CIPHER_REF_HINT)) ? free(ctx->hint) : (void)0;
+    (ctx->misc && !(ctx->__ref & CIPHER_REF_MISC)) ? free(ctx->misc) : (void)0;
+    (ctx->text && !(ctx->__ref & CIPHER_REF_TEXT)) ? free(ctx->text) : (void)0;
+    (ctx->hash && !(ctx->__ref & CIPHER_REF_HASH)) ? free(ctx->hash) : (void)0;
+    ctx->hint = 0;
+    ctx->misc = 0;
+    ctx->text = 0;
+    ctx->hash = 0;
     ctx->type = CIPHER_EMAIL;
     ctx->size = 16;
+    ctx->__ref = 0;
 }
 
 cipher_s *cipher_new(void)
@@ -458,34 +637,79 @@ void cipher_die(cipher_s *ctx)
     }
 }
 
+#undef CIPHER_PUT_FIELD
+#define CIPHER_PUT_FIELD(field, ref)                                              \
+    static int cipher_put_##field##_(cipher_s *ctx, c_arena_s *arena, cptr_t field) \
+    {                                                                             \
+        assert(ctx);                                                              \
+        str_t str = 0;                                                            \
+        if (field)                                                                \
+        {                                                                         \
+            size_t len = strlen((cstr_t)field);                                   \
+            str = arena ? c_arena_strndup(arena, field, len)                      \
+                        : (str_t)malloc(len + 1);                                 \
+            if (str == 0)                                                         \
+            {                                                                     \
+                return ~0;                                                        \
+            }                                                                     \
+            arena ? (void)0 : (void)memcpy(str, field, len + 1);                  \
+        }                                                                         \
+        /* a field in an arena is left there, the new value is a copy */          \
+        if (ctx->field && !(ctx->__ref & (ref)))                                  \
+        {                                                                         \
+            free(ctx->field);                                                     \
+        }                                                                         \
+        ctx->__ref = (str && arena) ? (ctx->__ref | (ref))                        \
+                                    : (ctx->__ref & ~(uint_t)(ref));              \
+        ctx->field = str;                                                         \
+        return 0;                                                                 \
+    }
+CIPHER_PUT_FIELD(hint, CIPHER_REF_HINT)
+CIPHER_PUT_FIELD(misc, CIPHER_REF_MISC)
+CIPHER_PUT_FIELD(text, CIPHER_REF_TEXT)
+CIPHER_PUT_FIELD(hash, CIPHER_REF_HASH)
+#undef CIPHER_PUT_FIELD
+
 #undef CIPHER_SET_FIELD
-#define CIPHER_SET_FIELD(field)                             \
-    int cipher_set_##field(cipher_s *ctx, cptr_t field)     \
-    {                                                       \
-        assert(ctx);                                        \
-        str_t str = 0;                                      \
-        if (field)                                          \
-        {                                                   \
-            str = (str_t)malloc(strlen((cstr_t)field) + 1); \
-            if (str == 0)                                   \
-            {                                               \
-                return ~0;                                  \
-            }                                               \
-            strcpy(str, (cstr_t)field);                     \
-        }                                                   \
-        if (ctx->field)                                     \
-        {                                                   \
-            free(ctx->field);                               \
-        }                                                   \
-        ctx->field = str;                                   \
-        return 0;                                           \
+#define CIPHER_SET_FIELD(field)                                           \
+    int cipher_set_##field(cipher_s *ctx, cptr_t field)                   \
+    {                                                                     \
+        return cipher_put_##field(ctx, 0, field);                         \
+    }                                                                     \
+    int cipher_put_##field(cipher_s *ctx, c_arena_s *arena, cptr_t field) \
+    {                                                                     \
+        return cipher_put_##field##_(ctx, arena, field);                  \
     }
 CIPHER_SET_FIELD(hint)
 CIPHER_SET_FIELD(misc)
 CIPHER_SET_FIELD(text)
-CIPHER_SET_FIELD(hash)
 #undef CIPHER_SET_FIELD
 
+int cipher_set_hash(cipher_s *ctx, cptr_t hash)
+{
+    return cipher_put_hash(ctx, 0, hash);
+}
+
+int cipher_put_hash(cipher_s *ctx, c_arena_s *arena, cptr_t hash)
+{
+    assert(ctx);
+    int idx = hash ? cipher_hash_index((cstr_t)hash) : -1;
+    if (idx < 0)
+    {
+        /* an unknown name is kept, but nothing can be generated from it */
+        int ok = cipher_put_hash_(ctx, arena, hash);
+        return (hash && ok == 0) ? ~0 : ok;
+    }
+    if (ctx->hash && !(ctx->__ref & CIPHER_REF_HASH))
+    {
+        free(ctx->hash);
+    }
+    /* the interned name is shared, it is never freed */
+    ctx->hash = (str_t)(uintptr_t)cipher_hash_names[idx];
+    ctx->__ref |= CIPHER_REF_HASH;
+    return 0;
+}
+
 void cipher_set_type(cipher_s *ctx, uint_t type)
 {
     assert(ctx);
@@ -495,27 +719,33 @@ void cipher_set_type(cipher_s *ctx, uint_t type)
 void cipher_set_size(cipher_s *ctx, uint_t size)
 {
     assert(ctx);
-    uint_t outsiz = cipher_hash(ctx->hash)->outsiz << 1;
+    const hash_s *hash = cipher_hash_(ctx);
+    uint_t outsiz = hash ? hash->outsiz << 1 : size;
     ctx->size = size < outsiz ? size : outsiz;
 }
 
 int cipher_copy(cipher_s *ctx, const cipher_s *obj)
+{
+    return cipher_put(ctx, 0, obj);
+}
+
+int cipher_put(cipher_s *ctx, c_arena_s *arena, const cipher_s *obj)
 {
     assert(ctx);
     assert(obj);
-    if (cipher_set_hint(ctx, cipher_get_hint(obj)))
+    if (cipher_put_hint(ctx, arena, cipher_get_hint(obj)))
     {
         return ~0;
     }
-    if (cipher_set_text(ctx, cipher_get_text(obj)))
+    if (cipher_put_text(ctx, arena, cipher_get_text(obj)))
     {
         return ~0;
     }
-    if (cipher_set_misc(ctx, cipher_get_misc(obj)))
+    if (cipher_put_misc(ctx, arena, cipher_get_misc(obj)))
     {
         return ~0;
     }
-    if (cipher_set_hash(ctx, cipher_get_hash(obj)))
+    if (cipher_put_hash(ctx, arena, cipher_get_hash(obj)))
     {
         return ~0;
     }
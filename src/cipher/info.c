@@ -8,38 +8,53 @@
 
 int c_info_add(c_info_s *ctx, cipher_s *obj)
 {
-    cipher_s *it = 0;
-    c_info_forenum(i, ctx)
+    if (cipher_get_hash(obj) && cipher_hash(cipher_get_hash(obj)) == 0)
     {
-        it = c_info_at(ctx, i);
-        if (cipher_get_text(it) && strcmp(cipher_get_text(it), cipher_get_text(obj)) == 0)
-        {
-            cipher_dtor(it);
-            break;
-        }
-        it = 0;
+        return INVALID;
+    }
+    /* the replacement is built first, so a failure leaves the entries as they were */
+    cipher_s tmp[1];
+    cipher_ctor(tmp);
+    int ok = cipher_put(tmp, c_info_arena(ctx), obj);
+    if (ok != SUCCESS)
+    {
+        cipher_dtor(tmp);
+        return ok;
+    }
+    cipher_s *it = c_info_find(ctx, cipher_get_text(tmp));
+    if (it)
+    {
+        /* the text stays the same, so does its slot in the index */
+        cipher_dtor(it);
+        cipher_move(it, tmp);
     }
-    if (it == 0)
+    else
     {
-        it = c_info_push(ctx);
+        /* a slot freed by c_info_del is reused first */
+        it = c_info_claim(ctx);
         if (it == 0)
         {
+            cipher_dtor(tmp);
             return FAILURE;
         }
-        cipher_ctor(it);
+        cipher_move(it, tmp);
+        ok = c_info_remember(ctx, it);
     }
-    return cipher_copy(it, obj);
+    c_info_mark(ctx, cipher_get_text(it));
+    return ok;
 }
 
 int c_info_del(c_info_s *ctx, cipher_s *obj)
 {
     int ret = FAILURE;
-    c_info_foreach(it, ctx)
+    cipher_s *it;
+    while ((it = c_info_find(ctx, cipher_get_text(obj))) != NULL)
     {
-        if (cipher_get_text(it) && strcmp(cipher_get_text(it), cipher_get_text(obj)) == 0)
+        c_info_erase(ctx, (size_t)(it - c_info_ptr(ctx)));
+        ret = SUCCESS;
+        if (it == obj)
         {
-            cipher_dtor(it);
-            ret = SUCCESS;
+            break;
         }
     }
     return ret;
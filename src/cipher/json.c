@@ -32,6 +32,9 @@ int c_json_export_info(const cJSON *in, c_info_s *out)
     cipher_s ctx[1];
     cJSON *object;
     int n = cJSON_GetArraySize(in);
+    /* c_info_add copies the fields into the arena */
+    c_info_use_arena(out);
+    c_info_reserve(out, c_info_num(out) + (size_t)(n > 0 ? n : 0));
     for (int i = 0; i != n; ++i)
     {
         cipher_ctor(ctx);
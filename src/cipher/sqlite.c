@@ -5,6 +5,10 @@
 */
 
 #include "cipher/sqlite.h"
+#include "cipher/cipher.h"
+
+#include "cksum/sha256.h"
+#include "cksum/util/conv.h"
 
 #include <assert.h>
 #include <string.h>
@@ -16,6 +20,10 @@ static struct
     const char *rule_1;
     const char *rule_2;
     const char *rule_3;
+    const char *key;
+    const char *key_sum;
+    const char *key_hash;
+    const char *key_state;
     const char *word;
     const char *word_text;
     const char *info;
@@ -25,6 +33,7 @@ static struct
     const char *info_hash;
     const char *info_size;
     const char *info_type;
+    const char *info_fts;
 } local[1] = {
     {
         .rule = "rule",
@@ -32,6 +41,10 @@ static struct
         .rule_1 = "1",
         .rule_2 = "2",
         .rule_3 = "3",
+        .key = "rule_key",
+        .key_sum = "sum",
+        .key_hash = "hash",
+        .key_state = "state",
         .word = "word",
         .word_text = "text",
         .info = "info",
@@ -41,70 +54,245 @@ static struct
         .info_size = "size",
         .info_hash = "hash",
         .info_type = "type",
+        .info_fts = "info_fts",
     },
 };
 
-int c_sqlite_begin(sqlite3 *db)
+void c_sqlite_ctor(c_sqlite_s *ctx, sqlite3 *db)
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
-    sqlite3_prepare(db, "begin;", -1, &stmt, 0);
-    sqlite3_step(stmt);
-    return sqlite3_finalize(stmt);
+    assert(ctx);
+    ctx->db = db;
+    memset(ctx->__stmt, 0, sizeof(ctx->__stmt));
 }
 
-int c_sqlite_commit(sqlite3 *db)
+void c_sqlite_dtor(c_sqlite_s *ctx)
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
-    sqlite3_prepare(db, "commit;", -1, &stmt, 0);
-    sqlite3_step(stmt);
-    return sqlite3_finalize(stmt);
+    assert(ctx);
+    for (unsigned int i = 0; i != C_SQLITE_TOTAL; ++i)
+    {
+        sqlite3_finalize(ctx->__stmt[i]);
+    }
+    c_sqlite_ctor(ctx, ctx->db);
 }
 
-int c_sqlite_create_rule(sqlite3 *db)
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/*
+ The pragmas of each profile, locking_mode goes before journal_mode so that an
+ exclusive lock is taken first. A negative cache_size is in KiB. A page read
+ through the map still takes an entry of the cache.
+*/
+static const struct
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
+    int flags;
+    const char *pragma;
+} c_sqlite_profile_[C_SQLITE_PROFILE] = {
+    {
+        /* a writer waits for the lock of another one rather than failing at once */
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+        "pragma busy_timeout=5000;"
+        "pragma locking_mode=normal;"
+        "pragma journal_mode=wal;"
+        "pragma synchronous=normal;"
+        "pragma mmap_size=67108864;"
+        "pragma cache_size=-8192;"
+        "pragma temp_store=memory;",
+    },
+    {
+        /* a crash may leave the file torn, which only costs the import */
+        SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX,
+        "pragma locking_mode=exclusive;"
+        "pragma journal_mode=memory;"
+        "pragma synchronous=off;"
+        "pragma mmap_size=0;"
+        "pragma cache_size=-262144;"
+        "pragma temp_store=memory;",
+    },
+    {
+        /* the journal belongs to the writers, it is left as it is */
+        SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+        "pragma query_only=1;"
+        "pragma locking_mode=normal;"
+        "pragma synchronous=off;"
+        "pragma mmap_size=1073741824;"
+        "pragma cache_size=-8192;"
+        "pragma temp_store=memory;",
+    },
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
 
-    sqlite3_str *str = sqlite3_str_new(db);
+int c_sqlite_open(c_sqlite_s *ctx, cstr_t path, c_sqlite_profile_e profile)
+{
+    assert(ctx);
+    assert(path);
+    assert(profile < C_SQLITE_PROFILE);
+    sqlite3 *db = 0;
+    int ok = sqlite3_open_v2(path, &db, c_sqlite_profile_[profile].flags, 0);
+    c_sqlite_ctor(ctx, db);
+    if (ok == SQLITE_OK)
     {
-        const char *sql = "create table if not exists %s(%s text,%s text,%s text,%s text);";
-        sqlite3_str_appendf(str, sql, local->rule,
-                            local->rule_0, local->rule_1, local->rule_2, local->rule_3);
+        ok = sqlite3_exec(db, c_sqlite_profile_[profile].pragma, 0, 0, 0);
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
-    sqlite3_step(stmt);
+    return ok;
+}
 
-    return sqlite3_finalize(stmt);
+int c_sqlite_close(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    sqlite3 *db = ctx->db;
+    c_sqlite_dtor(ctx);
+    ctx->db = 0;
+    return sqlite3_close(db);
 }
 
-int c_sqlite_create_word(sqlite3 *db)
+#undef C_SQLITE_NAP
+#define C_SQLITE_NAP 10
+#undef C_SQLITE_TRY
+#define C_SQLITE_TRY 500
+
+int c_sqlite_backup(c_sqlite_s *ctx, cstr_t path, int pages, c_sqlite_backup_f func, void *arg)
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
+    assert(ctx);
+    assert(path);
+    /* a step never gets the lock of a transaction this connection holds */
+    if (!sqlite3_get_autocommit(ctx->db))
+    {
+        return SQLITE_LOCKED;
+    }
+    sqlite3 *db = 0;
+    int ok = sqlite3_open_v2(path, &db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, 0);
+    if (ok != SQLITE_OK)
+    {
+        sqlite3_close(db);
+        return ok;
+    }
+    sqlite3_backup *backup = sqlite3_backup_init(db, "main", ctx->db, "main");
+    if (backup == 0)
+    {
+        ok = sqlite3_errcode(db);
+        sqlite3_close(db);
+        return ok;
+    }
+    int nap = 0;
+    do
+    {
+        ok = sqlite3_backup_step(backup, pages > 0 ? pages : -1);
+        if (func && (ok == SQLITE_OK || ok == SQLITE_DONE) &&
+            func(arg, sqlite3_backup_remaining(backup), sqlite3_backup_pagecount(backup)))
+        {
+            ok = ok == SQLITE_DONE ? ok : SQLITE_ABORT;
+            break;
+        }
+        /* a writer holds the lock, it is given a moment a few times over */
+        if (ok == SQLITE_BUSY || ok == SQLITE_LOCKED)
+        {
+            if (++nap == C_SQLITE_TRY)
+            {
+                break;
+            }
+            sqlite3_sleep(C_SQLITE_NAP);
+        }
+        else
+        {
+            nap = 0;
+        }
+    } while (ok == SQLITE_OK || ok == SQLITE_BUSY || ok == SQLITE_LOCKED);
+    int ret = sqlite3_backup_finish(backup);
+    sqlite3_close(db);
+    if (ok == SQLITE_DONE)
+    {
+        return ret;
+    }
+    return ok;
+}
 
-    sqlite3_str *str = sqlite3_str_new(db);
+int c_sqlite_vacuum(c_sqlite_s *ctx, cstr_t path)
+{
+    assert(ctx);
+    assert(path);
+    /* it is run once, so its statement is not kept by the handle */
+    sqlite3_stmt *stmt = 0;
+    int ok = sqlite3_prepare_v2(ctx->db, "vacuum into ?;", -1, &stmt, 0);
+    if (ok == SQLITE_OK)
     {
-        const char *sql = "create table if not exists %s(%s text primary key);";
-        sqlite3_str_appendf(str, sql, local->word, local->word_text);
+        sqlite3_bind_text(stmt, 1, path, -1, SQLITE_STATIC);
+        sqlite3_step(stmt);
+        ok = sqlite3_finalize(stmt);
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
-    sqlite3_step(stmt);
+    return ok;
+}
+
+#undef C_SQLITE_ROWS
+#define C_SQLITE_ROWS 0x400
 
-    return sqlite3_finalize(stmt);
+/* the rows of a bulk insert, the parameters of a statement are limited */
+static int c_sqlite_rows_(sqlite3 *db, int cols)
+{
+    int rows = sqlite3_limit(db, SQLITE_LIMIT_VARIABLE_NUMBER, -1) / cols;
+    return rows < C_SQLITE_ROWS ? rows : C_SQLITE_ROWS;
 }
 
-int c_sqlite_create_info(sqlite3 *db)
+static void c_sqlite_upsert_info_(sqlite3_str *str)
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
+    const char *sql = " on conflict(%s) do update set "
+                      "%s=excluded.%s,%s=excluded.%s,%s=excluded.%s,%s=excluded.%s,%s=excluded.%s;";
+    sqlite3_str_appendf(str, sql, local->info_text,
+                        local->info_hash, local->info_hash, local->info_size, local->info_size,
+                        local->info_type, local->info_type, local->info_misc, local->info_misc,
+                        local->info_hint, local->info_hint);
+}
 
-    sqlite3_str *str = sqlite3_str_new(db);
+static void c_sqlite_sql_(sqlite3 *db, sqlite3_str *str, c_sqlite_e id)
+{
+    switch (id)
+    {
+    case C_SQLITE_BEGIN:
+        sqlite3_str_appendall(str, "begin;");
+        break;
+    case C_SQLITE_SAVE:
+        sqlite3_str_appendall(str, "savepoint load;");
+        break;
+    case C_SQLITE_RELEASE:
+        sqlite3_str_appendall(str, "release load;");
+        break;
+    case C_SQLITE_ROLLBACK:
+        sqlite3_str_appendall(str, "rollback to load;");
+        break;
+    case C_SQLITE_COMMIT:
+        sqlite3_str_appendall(str, "commit;");
+        break;
+    case C_SQLITE_ABORT:
+        sqlite3_str_appendall(str, "rollback;");
+        break;
+    case C_SQLITE_CREATE_RULE:
+    {
+        /* the names of the columns are numbers, so they are quoted */
+        const char *sql = "create table if not exists %s(\"%w\" text,\"%w\" text,\"%w\" text,\"%w\" text);";
+        sqlite3_str_appendf(str, sql, local->rule,
+                            local->rule_0, local->rule_1, local->rule_2, local->rule_3);
+    }
+    break;
+    case C_SQLITE_CREATE_KEY:
+    {
+        const char *sql = "create table if not exists %s(%s text,%s text,%s blob,"
+                          "primary key(%s,%s)) without rowid;";
+        sqlite3_str_appendf(str, sql, local->key, local->key_sum, local->key_hash, local->key_state,
+                            local->key_sum, local->key_hash);
+    }
+    break;
+    case C_SQLITE_CREATE_WORD:
+    {
+        const char *sql = "create table if not exists %s(%s text primary key);";
+        sqlite3_str_appendf(str, sql, local->word, local->word_text);
+    }
+    break;
+    case C_SQLITE_CREATE_INFO:
     {
         const char *sql = "create table if not exists %s("
                           "%s text primary key,"
@@ -115,291 +303,1285 @@ int c_sqlite_create_info(sqlite3 *db)
         sqlite3_str_appendf(str, sql, local->info, local->info_text, local->info_hash,
                             local->info_size, local->info_type, local->info_misc, local->info_hint);
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
-    sqlite3_step(stmt);
-
-    return sqlite3_finalize(stmt);
+    break;
+    case C_SQLITE_DELETE_RULE:
+        sqlite3_str_appendf(str, "drop table if exists %s;", local->rule);
+        break;
+    case C_SQLITE_DELETE_KEY:
+        sqlite3_str_appendf(str, "drop table if exists %s;", local->key);
+        break;
+    case C_SQLITE_DELETE_WORD:
+        sqlite3_str_appendf(str, "drop table if exists %s;", local->word);
+        break;
+    case C_SQLITE_DELETE_INFO:
+        sqlite3_str_appendf(str, "drop table if exists %s;", local->info);
+        break;
+    case C_SQLITE_COUNT_WORD:
+        sqlite3_str_appendf(str, "select count(%s) from %s;", local->word_text, local->word);
+        break;
+    case C_SQLITE_COUNT_INFO:
+        sqlite3_str_appendf(str, "select count(%s) from %s;", local->info_text, local->info);
+        break;
+    case C_SQLITE_OUT_RULE:
+        sqlite3_str_appendf(str, "select * from %s;", local->rule);
+        break;
+    case C_SQLITE_OUT_WORD:
+        sqlite3_str_appendf(str, "select * from %s;", local->word);
+        break;
+    case C_SQLITE_OUT_INFO:
+        sqlite3_str_appendf(str, "select * from %s order by %s asc;", local->info, local->info_text);
+        break;
+    case C_SQLITE_ADD_RULE:
+    {
+        const char *sql = "insert into %s select ?1,?2,?3,?4 where not exists(select 1 from %s where "
+                          "\"%w\" is ?1 and \"%w\" is ?2 and \"%w\" is ?3 and \"%w\" is ?4);";
+        sqlite3_str_appendf(str, sql, local->rule, local->rule,
+                            local->rule_0, local->rule_1, local->rule_2, local->rule_3);
+    }
+    break;
+    case C_SQLITE_ADD_WORD:
+        sqlite3_str_appendf(str, "insert into %s values(?);", local->word);
+        break;
+    case C_SQLITE_ADD_INFO:
+        sqlite3_str_appendf(str, "insert into %s values(?,?,?,?,?,?);", local->info);
+        break;
+    case C_SQLITE_DEL_RULE:
+    {
+        const char *sql = "delete from %s where \"%w\" is ?1 and \"%w\" is ?2 and \"%w\" is ?3 and \"%w\" is ?4;";
+        sqlite3_str_appendf(str, sql, local->rule,
+                            local->rule_0, local->rule_1, local->rule_2, local->rule_3);
+    }
+    break;
+    case C_SQLITE_DEL_WORD:
+        sqlite3_str_appendf(str, "delete from %s where %s = ?;", local->word, local->word_text);
+        break;
+    case C_SQLITE_DEL_INFO:
+        sqlite3_str_appendf(str, "delete from %s where %s = ?;", local->info, local->info_text);
+        break;
+    case C_SQLITE_PUT_WORD:
+    {
+        const char *sql = "insert into %s values(?) on conflict(%s) do nothing;";
+        sqlite3_str_appendf(str, sql, local->word, local->word_text);
+    }
+    break;
+    case C_SQLITE_PUT_INFO:
+        sqlite3_str_appendf(str, "insert into %s values(?,?,?,?,?,?)", local->info);
+        c_sqlite_upsert_info_(str);
+        break;
+    case C_SQLITE_GET_KEY:
+    {
+        const char *sql = "select %s from %s where %s = ? and %s = ?;";
+        sqlite3_str_appendf(str, sql, local->key_state, local->key, local->key_sum, local->key_hash);
+    }
+    break;
+    case C_SQLITE_PUT_KEY:
+        sqlite3_str_appendf(str, "insert or replace into %s values(?,?,?);", local->key);
+        break;
+    case C_SQLITE_LOAD_WORD:
+    {
+        sqlite3_str_appendf(str, "insert into %s values(?)", local->word);
+        for (int i = c_sqlite_rows_(db, 1); --i;)
+        {
+            sqlite3_str_appendall(str, ",(?)");
+        }
+        sqlite3_str_appendf(str, " on conflict(%s) do nothing;", local->word_text);
+    }
+    break;
+    case C_SQLITE_LOAD_INFO:
+    {
+        sqlite3_str_appendf(str, "insert into %s values(?,?,?,?,?,?)", local->info);
+        for (int i = c_sqlite_rows_(db, 6); --i;)
+        {
+            sqlite3_str_appendall(str, ",(?,?,?,?,?,?)");
+        }
+        c_sqlite_upsert_info_(str);
+    }
+    break;
+    case C_SQLITE_GET_INFO:
+        sqlite3_str_appendf(str, "select * from %s where %s = ?;", local->info, local->info_text);
+        break;
+    case C_SQLITE_PAGE_INFO:
+    {
+        const char *sql = "select * from %s where %s is not null order by %s asc limit ? offset ?;";
+        sqlite3_str_appendf(str, sql, local->info, local->info_text, local->info_text);
+    }
+    break;
+    case C_SQLITE_RANK_INFO:
+    {
+        const char *sql = "select count(%s) from %s where %s < ?1;";
+        sqlite3_str_appendf(str, sql, local->info_text, local->info, local->info_text);
+    }
+    break;
+    case C_SQLITE_WALK_INFO:
+    {
+        const char *sql = "select %s from %s where %s >= ?1 order by %s asc;";
+        sqlite3_str_appendf(str, sql, local->info_text, local->info, local->info_text, local->info_text);
+    }
+    break;
+    case C_SQLITE_PREFIX_INFO:
+    {
+        const char *sql = "select * from %s where %s >= ?1 and %s < ?2 order by %s asc;";
+        sqlite3_str_appendf(str, sql, local->info, local->info_text, local->info_text, local->info_text);
+    }
+    break;
+    case C_SQLITE_MATCH_INFO:
+    {
+        const char *sql = "select * from %s where rowid in (select rowid from %s where %s match ?) "
+                          "and %s is not null order by %s asc;";
+        sqlite3_str_appendf(str, sql, local->info, local->info_fts, local->info_text,
+                            local->info_text, local->info_text);
+    }
+    break;
+    case C_SQLITE_SCAN_INFO:
+    {
+        const char *sql = "select * from %s where instr(%s,?1) order by %s asc;";
+        sqlite3_str_appendf(str, sql, local->info, local->info_text, local->info_text);
+    }
+    break;
+    case C_SQLITE_TOTAL:
+    default:
+        break;
+    }
 }
 
-int c_sqlite_delete_rule(sqlite3 *db)
+/* the statement of id, ready to be bound and stepped, a statement that fails to compile is not kept */
+static int c_sqlite_stmt_(c_sqlite_s *ctx, c_sqlite_e id, sqlite3_stmt **out)
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
-
-    sqlite3_str *str = sqlite3_str_new(db);
+    sqlite3_stmt *stmt = ctx->__stmt[id];
+    if (stmt)
     {
-        const char *sql = "drop table if exists %s;";
-        sqlite3_str_appendf(str, sql, local->rule);
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        *out = stmt;
+        return SQLITE_OK;
     }
+    sqlite3_str *str = sqlite3_str_new(ctx->db);
+    c_sqlite_sql_(ctx->db, str, id);
     char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
+    int ok = sqlite3_prepare_v3(ctx->db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, 0);
     sqlite3_free(sql);
-    sqlite3_step(stmt);
-
-    return sqlite3_finalize(stmt);
+    if (ok == SQLITE_OK && stmt == 0)
+    {
+        ok = SQLITE_MISUSE;
+    }
+    ctx->__stmt[id] = stmt;
+    *out = stmt;
+    return ok;
 }
 
-int c_sqlite_delete_word(sqlite3 *db)
+/* a statement that takes no parameters and returns no rows */
+static int c_sqlite_exec_(c_sqlite_s *ctx, c_sqlite_e id)
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
-
-    sqlite3_str *str = sqlite3_str_new(db);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, id, &stmt);
+    if (ok != SQLITE_OK)
     {
-        const char *sql = "drop table if exists %s;";
-        sqlite3_str_appendf(str, sql, local->word);
+        return ok;
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
     sqlite3_step(stmt);
-
-    return sqlite3_finalize(stmt);
+    return sqlite3_reset(stmt);
 }
 
-int c_sqlite_delete_info(sqlite3 *db)
+static size_t c_sqlite_count_(c_sqlite_s *ctx, c_sqlite_e id)
 {
-    assert(db);
-    sqlite3_stmt *stmt = 0;
-
-    sqlite3_str *str = sqlite3_str_new(db);
+    sqlite3_stmt *stmt;
+    sqlite3_int64 num = 0;
+    if (c_sqlite_stmt_(ctx, id, &stmt) != SQLITE_OK)
     {
-        const char *sql = "drop table if exists %s;";
-        sqlite3_str_appendf(str, sql, local->info);
+        return 0;
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
-    sqlite3_step(stmt);
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        num = sqlite3_column_int64(stmt, 0);
+    }
+    sqlite3_reset(stmt);
+    return num > 0 ? (size_t)num : 0;
+}
 
-    return sqlite3_finalize(stmt);
+size_t c_sqlite_count_word(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    return c_sqlite_count_(ctx, C_SQLITE_COUNT_WORD);
 }
 
-int c_sqlite_init(sqlite3 *db)
+size_t c_sqlite_count_info(c_sqlite_s *ctx)
 {
-    assert(db);
-    c_sqlite_create_rule(db);
-    c_sqlite_create_word(db);
-    c_sqlite_create_info(db);
-    return c_sqlite_begin(db);
+    assert(ctx);
+    return c_sqlite_count_(ctx, C_SQLITE_COUNT_INFO);
 }
 
-int c_sqlite_exit(sqlite3 *db)
+int c_sqlite_begin(c_sqlite_s *ctx)
 {
-    assert(db);
-    return c_sqlite_commit(db);
+    assert(ctx);
+    return c_sqlite_exec_(ctx, C_SQLITE_BEGIN);
 }
 
-int c_sqlite_out_word(sqlite3 *db, c_word_s *out)
+int c_sqlite_commit(c_sqlite_s *ctx)
 {
-    assert(db);
-    assert(out);
-    sqlite3_stmt *stmt = 0;
+    assert(ctx);
+    return c_sqlite_exec_(ctx, C_SQLITE_COMMIT);
+}
 
-    sqlite3_str *str = sqlite3_str_new(db);
-    {
-        const char *sql = "select * from %s;";
-        sqlite3_str_appendf(str, sql, local->word);
-    }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
+int c_sqlite_rollback(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    return c_sqlite_exec_(ctx, C_SQLITE_ABORT);
+}
 
-    while (sqlite3_step(stmt) == SQLITE_ROW)
+int c_sqlite_create_rule(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    int ok = c_sqlite_exec_(ctx, C_SQLITE_CREATE_RULE);
+    if (ok == SQLITE_OK)
     {
-        const unsigned char *text = sqlite3_column_text(stmt, 0);
-        if (text == 0)
-        {
-            continue;
-        }
-        str_s *ctx = c_word_push(out);
-        str_puts(ctx, text);
+        ok = c_sqlite_exec_(ctx, C_SQLITE_CREATE_KEY);
     }
+    return ok;
+}
 
-    return sqlite3_finalize(stmt);
+int c_sqlite_create_word(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    return c_sqlite_exec_(ctx, C_SQLITE_CREATE_WORD);
 }
 
-int c_sqlite_out_info(sqlite3 *db, c_info_s *out)
+/*
+ The full text index of info is an external content table of trigrams, so it
+ finds any substring of three characters or more. The triggers keep it in step
+ with info. It is created once, so its statements are not kept by the handle.
+ Without the fts5 module, nothing is created and the searches scan the table.
+*/
+static int c_sqlite_has_fts_(c_sqlite_s *ctx)
 {
-    assert(db);
-    assert(out);
     sqlite3_stmt *stmt = 0;
+    sqlite3_prepare_v2(ctx->db, "select 1 from sqlite_master where name = ?;", -1, &stmt, 0);
+    sqlite3_bind_text(stmt, 1, local->info_fts, -1, SQLITE_STATIC);
+    int ok = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    return ok == SQLITE_ROW;
+}
 
-    sqlite3_str *str = sqlite3_str_new(db);
+static void c_sqlite_create_fts_(c_sqlite_s *ctx)
+{
+    if (c_sqlite_has_fts_(ctx))
     {
-        const char *sql = "select * from %s order by %s asc;";
-        sqlite3_str_appendf(str, sql, local->info, local->info_text);
+        return;
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
 
-    while (sqlite3_step(stmt) == SQLITE_ROW)
+    sqlite3_str *str = sqlite3_str_new(ctx->db);
     {
-        const unsigned char *text = sqlite3_column_text(stmt, 0);
-        if (text == 0)
-        {
-            continue;
-        }
-        cipher_s *ctx = c_info_push(out);
-        cipher_set_text(ctx, text);
-        if (((void)(text = sqlite3_column_text(stmt, 1)), text))
-        {
-            cipher_set_hash(ctx, text);
-        }
-        else
-        {
-            cipher_set_hash(ctx, "MD5");
-        }
-        cipher_set_size(ctx, (unsigned int)sqlite3_column_int(stmt, 2));
-        cipher_set_type(ctx, (unsigned int)sqlite3_column_int(stmt, 3));
-        if (((void)(text = sqlite3_column_text(stmt, 4)), text) &&
-            cipher_get_type(ctx) == CIPHER_OTHER)
-        {
-            cipher_set_misc(ctx, text);
-        }
-        if (((void)(text = sqlite3_column_text(stmt, 5)), text))
-        {
-            cipher_set_hint(ctx, text);
-        }
+        const char *sql = "create virtual table %s using fts5(%s,%s,content=%Q,"
+                          "tokenize=\"trigram case_sensitive 1\");";
+        sqlite3_str_appendf(str, sql, local->info_fts, local->info_text, local->info_hint, local->info);
     }
-
-    return sqlite3_finalize(stmt);
+    {
+        const char *sql = "drop trigger if exists %s_ai;"
+                          "create trigger %s_ai after insert on %s begin "
+                          "insert into %s(rowid,%s,%s) values(new.rowid,new.%s,new.%s); end;";
+        sqlite3_str_appendf(str, sql, local->info_fts, local->info_fts, local->info,
+                            local->info_fts, local->info_text, local->info_hint, local->info_text, local->info_hint);
+    }
+    {
+        const char *sql = "drop trigger if exists %s_ad;"
+                          "create trigger %s_ad after delete on %s begin "
+                          "insert into %s(%s,rowid,%s,%s) values('delete',old.rowid,old.%s,old.%s); end;";
+        sqlite3_str_appendf(str, sql, local->info_fts, local->info_fts, local->info,
+                            local->info_fts, local->info_fts, local->info_text, local->info_hint,
+                            local->info_text, local->info_hint);
+    }
+    {
+        const char *sql = "drop trigger if exists %s_au;"
+                          "create trigger %s_au after update on %s begin "
+                          "insert into %s(%s,rowid,%s,%s) values('delete',old.rowid,old.%s,old.%s);"
+                          "insert into %s(rowid,%s,%s) values(new.rowid,new.%s,new.%s); end;";
+        sqlite3_str_appendf(str, sql, local->info_fts, local->info_fts, local->info,
+                            local->info_fts, local->info_fts, local->info_text, local->info_hint,
+                            local->info_text, local->info_hint,
+                            local->info_fts, local->info_text, local->info_hint, local->info_text, local->info_hint);
+    }
+    /* the rows that are already in info are indexed at once */
+    sqlite3_str_appendf(str, "insert into %s(%s) values('rebuild');", local->info_fts, local->info_fts);
+    char *sql = sqlite3_str_finish(str);
+    /* a failed statement stops the ones after it, so no trigger is left without the table */
+    sqlite3_exec(ctx->db, sql, 0, 0, 0);
+    sqlite3_free(sql);
 }
 
-int c_sqlite_add_word(sqlite3 *db, const c_word_s *in)
+/* the triggers go first, an insert into info must not reach a missing table */
+static int c_sqlite_delete_fts_(c_sqlite_s *ctx)
 {
-    assert(db);
-    assert(in);
-    sqlite3_stmt *stmt = 0;
-
-    sqlite3_str *str = sqlite3_str_new(db);
+    sqlite3_str *str = sqlite3_str_new(ctx->db);
     {
-        const char *sql = "insert into %s values(?);";
-        sqlite3_str_appendf(str, sql, local->word);
+        const char *sql = "drop trigger if exists %s_ai;"
+                          "drop trigger if exists %s_ad;"
+                          "drop trigger if exists %s_au;"
+                          "drop table if exists %s;";
+        sqlite3_str_appendf(str, sql, local->info_fts, local->info_fts, local->info_fts, local->info_fts);
     }
     char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
+    int ok = sqlite3_exec(ctx->db, sql, 0, 0, 0);
     sqlite3_free(sql);
+    return ok;
+}
 
-    c_word_foreach(it, in)
+int c_sqlite_create_info(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    int ok = c_sqlite_exec_(ctx, C_SQLITE_CREATE_INFO);
+    if (ok == SQLITE_OK)
     {
-        if (str_len(it))
-        {
-            sqlite3_reset(stmt);
-            sqlite3_bind_text(stmt, 1, str_val(it), (int)str_len(it), SQLITE_STATIC);
-            sqlite3_step(stmt);
-        }
+        c_sqlite_create_fts_(ctx);
     }
+    return ok;
+}
 
-    return sqlite3_finalize(stmt);
+int c_sqlite_delete_rule(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    c_sqlite_exec_(ctx, C_SQLITE_DELETE_KEY);
+    return c_sqlite_exec_(ctx, C_SQLITE_DELETE_RULE);
 }
 
-int c_sqlite_add_info(sqlite3 *db, const c_info_s *in)
+int c_sqlite_delete_word(c_sqlite_s *ctx)
 {
-    assert(db);
-    assert(in);
+    assert(ctx);
+    return c_sqlite_exec_(ctx, C_SQLITE_DELETE_WORD);
+}
+
+int c_sqlite_delete_info(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    /* the index of the rows that are gone must go too */
+    c_sqlite_delete_fts_(ctx);
+    return c_sqlite_exec_(ctx, C_SQLITE_DELETE_INFO);
+}
+int c_sqlite_init(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    c_sqlite_create_rule(ctx);
+    c_sqlite_create_word(ctx);
+    c_sqlite_create_info(ctx);
+    return c_sqlite_begin(ctx);
+}
+
+int c_sqlite_exit(c_sqlite_s *ctx)
+{
+    assert(ctx);
+    return c_sqlite_commit(ctx);
+}
+
+int c_sqlite_has_init(c_sqlite_s *ctx)
+{
+    assert(ctx);
     sqlite3_stmt *stmt = 0;
+    sqlite3_prepare_v2(ctx->db, "select count(*) from sqlite_master where type = 'table' and name in (?,?);", -1, &stmt, 0);
+    sqlite3_bind_text(stmt, 1, local->word, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, local->info, -1, SQLITE_STATIC);
+    int num = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_finalize(stmt);
+    return num == 2;
+}
 
-    sqlite3_str *str = sqlite3_str_new(db);
+int c_sqlite_out_rule(c_sqlite_s *ctx, c_rule_s *out)
+{
+    assert(ctx);
+    assert(out);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_OUT_RULE, &stmt);
+    if (ok != SQLITE_OK)
     {
-        const char *sql = "insert into %s values(?,?,?,?,?,?);";
-        sqlite3_str_appendf(str, sql, local->info);
+        return ok;
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
 
-    c_info_foreach(it, in)
+    while (sqlite3_step(stmt) == SQLITE_ROW)
     {
-        if (cipher_get_text(it))
+        rule_s *it = c_rule_push(out);
+        if (it == 0)
         {
-            sqlite3_reset(stmt);
-            sqlite3_bind_int(stmt, 3, (int)cipher_get_size(it));
-            sqlite3_bind_int(stmt, 4, (int)cipher_get_type(it));
-            {
-                int size = (int)strlen(cipher_get_text(it));
-                sqlite3_bind_text(stmt, 1, cipher_get_text(it), size, SQLITE_STATIC);
-            }
-            {
-                int size = cipher_get_hash(it)
-                               ? (int)strlen(cipher_get_hash(it))
-                               : 0;
-                sqlite3_bind_text(stmt, 2, cipher_get_hash(it), size, SQLITE_STATIC);
-            }
-            {
-                int size = (cipher_get_misc(it) && cipher_get_type(it) == CIPHER_OTHER)
-                               ? (int)strlen(cipher_get_misc(it))
-                               : 0;
-                sqlite3_bind_text(stmt, 5, cipher_get_misc(it), size, SQLITE_STATIC);
-            }
+            break;
+        }
+        for (int i = 0; i != 4; ++i)
+        {
+            const unsigned char *text = sqlite3_column_text(stmt, i);
+            if (text)
             {
-                int size = cipher_get_hint(it)
-                               ? (int)strlen(cipher_get_hint(it))
-                               : 0;
-                sqlite3_bind_text(stmt, 6, cipher_get_hint(it), size, SQLITE_STATIC);
+                str_puts(it->r + i, text);
             }
-            sqlite3_step(stmt);
         }
     }
 
-    return sqlite3_finalize(stmt);
+    return sqlite3_reset(stmt);
 }
 
-int c_sqlite_del_word(sqlite3 *db, const c_word_s *in)
+/* the strings of a rule as the parameters ?1 to ?4, an empty one is null */
+static void c_sqlite_bind_rule(sqlite3_stmt *stmt, const rule_s *it)
 {
-    assert(db);
-    assert(in);
-    sqlite3_stmt *stmt = 0;
+    for (int i = 0; i != 4; ++i)
+    {
+        if (str_len(it->r + i))
+        {
+            sqlite3_bind_text(stmt, i + 1, str_val(it->r + i), (int)str_len(it->r + i), SQLITE_STATIC);
+        }
+        else
+        {
+            sqlite3_bind_null(stmt, i + 1);
+        }
+    }
+}
 
-    sqlite3_str *str = sqlite3_str_new(db);
+static int c_sqlite_each_rule_(c_sqlite_s *ctx, c_sqlite_e id, const c_rule_s *in)
+{
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, id, &stmt);
+    if (ok != SQLITE_OK)
     {
-        const char *sql = "delete from %s where %s = ?;";
-        sqlite3_str_appendf(str, sql, local->word, local->word_text);
+        return ok;
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
 
-    c_word_foreach(it, in)
+    c_rule_foreach(it, in)
     {
-        if (str_len(it))
-        {
-            sqlite3_reset(stmt);
-            sqlite3_bind_text(stmt, 1, str_val(it), (int)str_len(it), SQLITE_STATIC);
-            sqlite3_step(stmt);
-        }
+        sqlite3_reset(stmt);
+        c_sqlite_bind_rule(stmt, it);
+        sqlite3_step(stmt);
     }
 
-    return sqlite3_finalize(stmt);
+    return sqlite3_reset(stmt);
 }
 
-int c_sqlite_del_info(sqlite3 *db, const c_info_s *in)
+int c_sqlite_add_rule(c_sqlite_s *ctx, const c_rule_s *in)
 {
-    assert(db);
+    assert(ctx);
     assert(in);
-    sqlite3_stmt *stmt = 0;
+    return c_sqlite_each_rule_(ctx, C_SQLITE_ADD_RULE, in);
+}
+
+int c_sqlite_del_rule(c_sqlite_s *ctx, const c_rule_s *in)
+{
+    assert(ctx);
+    assert(in);
+    return c_sqlite_each_rule_(ctx, C_SQLITE_DEL_RULE, in);
+}
 
-    sqlite3_str *str = sqlite3_str_new(db);
+/* the digest of the four strings of a rule, each one ends with a null byte */
+static void c_sqlite_sum_rule_(const rule_s *rule, char out[(SHA256_OUTSIZ << 1) + 1])
+{
+    unsigned char buf[SHA256_OUTSIZ];
+    sha256_s ctx[1];
+    sha256_init(ctx);
+    for (int i = 0; i != 4; ++i)
     {
-        const char *sql = "delete from %s where %s = ?;";
-        sqlite3_str_appendf(str, sql, local->info, local->info_text);
+        sha256_proc(ctx, str_val(rule->r + i), str_len(rule->r + i));
+        sha256_proc(ctx, "", 1);
     }
-    char *sql = sqlite3_str_finish(str);
-    sqlite3_prepare(db, sql, -1, &stmt, 0);
-    sqlite3_free(sql);
+    sha256_done(ctx, buf);
+    digest_lower(buf, SHA256_OUTSIZ, out);
+}
 
-    c_info_foreach(it, in)
+int c_sqlite_key_rule(c_sqlite_s *ctx, const rule_s *rule, cstr_t hash)
+{
+    assert(ctx);
+    assert(rule);
+    int id = hash ? cipher_hash_id(hash) : 0;
+    if (id < 0)
     {
-        if (cipher_get_text(it))
-        {
-            sqlite3_reset(stmt);
+        return SQLITE_NOTFOUND;
+    }
+    /* the interned name, so that the aliases share the cache */
+    hash = cipher_hash_name((unsigned int)id);
+    cipher_v2_rule(str_val(rule->r + 0), str_val(rule->r + 1), str_val(rule->r + 2), str_val(rule->r + 3));
+
+    char sum[(SHA256_OUTSIZ << 1) + 1];
+    c_sqlite_sum_rule_(rule, sum);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_GET_KEY, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+    sqlite3_bind_text(stmt, 1, sum, SHA256_OUTSIZ << 1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, hash, -1, SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW &&
+        cipher_v2_import(hash, sqlite3_column_blob(stmt, 0), (size_t)sqlite3_column_bytes(stmt, 0)) == SUCCESS)
+    {
+        return sqlite3_reset(stmt);
+    }
+    ok = sqlite3_reset(stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    /* not cached or not valid, derive the states, then take and keep them */
+    size_t siz = 0;
+    cipher_v2_export(hash, 0, &siz);
+    void *blob = sqlite3_malloc64(siz);
+    if (blob == 0)
+    {
+        return SQLITE_NOMEM;
+    }
+    cipher_v2_export(hash, blob, &siz);
+    cipher_v2_import(hash, blob, siz);
+    ok = c_sqlite_stmt_(ctx, C_SQLITE_PUT_KEY, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        sqlite3_free(blob);
+        return ok;
+    }
+    sqlite3_bind_text(stmt, 1, sum, SHA256_OUTSIZ << 1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, hash, -1, SQLITE_STATIC);
+    sqlite3_bind_blob64(stmt, 3, blob, siz, sqlite3_free);
+    sqlite3_step(stmt);
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_out_word(c_sqlite_s *ctx, c_word_s *out)
+{
+    assert(ctx);
+    assert(out);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_OUT_WORD, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    c_word_reserve(out, c_word_num(out) + c_sqlite_count_word(ctx));
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const unsigned char *text = sqlite3_column_text(stmt, 0);
+        if (text == 0)
+        {
+            continue;
+        }
+        str_puts(c_word_push(out), text);
+    }
+
+    return sqlite3_reset(stmt);
+}
+
+/* the columns of info in the order of the table, the text is not null */
+static void c_sqlite_row_info(sqlite3_stmt *stmt, cipher_s *it, c_arena_s *arena)
+{
+    const unsigned char *text = sqlite3_column_text(stmt, 0);
+    cipher_put_text(it, arena, text);
+    if (((void)(text = sqlite3_column_text(stmt, 1)), text))
+    {
+        cipher_put_hash(it, arena, text);
+    }
+    else
+    {
+        cipher_put_hash(it, arena, "MD5");
+    }
+    cipher_set_size(it, (unsigned int)sqlite3_column_int(stmt, 2));
+    cipher_set_type(it, (unsigned int)sqlite3_column_int(stmt, 3));
+    if (((void)(text = sqlite3_column_text(stmt, 4)), text) &&
+        cipher_get_type(it) == CIPHER_OTHER)
+    {
+        cipher_put_misc(it, arena, text);
+    }
+    if (((void)(text = sqlite3_column_text(stmt, 5)), text))
+    {
+        cipher_put_hint(it, arena, text);
+    }
+}
+
+int c_sqlite_out_info(c_sqlite_s *ctx, c_info_s *out)
+{
+    assert(ctx);
+    assert(out);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_OUT_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    /* the fields of a bulk load are released together */
+    c_info_use_arena(out);
+    c_arena_s *arena = c_info_arena(out);
+    c_info_reserve(out, c_info_num(out) + c_sqlite_count_info(ctx));
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const unsigned char *text = sqlite3_column_text(stmt, 0);
+        if (text == 0)
+        {
+            continue;
+        }
+        c_sqlite_row_info(stmt, c_info_push(out), arena);
+    }
+
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_add_word(c_sqlite_s *ctx, const c_word_s *in)
+{
+    assert(ctx);
+    assert(in);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_ADD_WORD, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    c_word_foreach(it, in)
+    {
+        if (str_len(it))
+        {
+            sqlite3_reset(stmt);
+            sqlite3_bind_text(stmt, 1, str_val(it), (int)str_len(it), SQLITE_STATIC);
+            sqlite3_step(stmt);
+        }
+    }
+
+    return sqlite3_reset(stmt);
+}
+
+/* the columns of info in the order of the table, as the parameters after col */
+static void c_sqlite_bind_info(sqlite3_stmt *stmt, int col, const cipher_s *it)
+{
+    sqlite3_bind_int(stmt, col + 3, (int)cipher_get_size(it));
+    sqlite3_bind_int(stmt, col + 4, (int)cipher_get_type(it));
+    {
+        int size = (int)strlen(cipher_get_text(it));
+        sqlite3_bind_text(stmt, col + 1, cipher_get_text(it), size, SQLITE_STATIC);
+    }
+    {
+        int size = cipher_get_hash(it)
+                       ? (int)strlen(cipher_get_hash(it))
+                       : 0;
+        sqlite3_bind_text(stmt, col + 2, cipher_get_hash(it), size, SQLITE_STATIC);
+    }
+    {
+        int size = (cipher_get_misc(it) && cipher_get_type(it) == CIPHER_OTHER)
+                       ? (int)strlen(cipher_get_misc(it))
+                       : 0;
+        sqlite3_bind_text(stmt, col + 5, cipher_get_misc(it), size, SQLITE_STATIC);
+    }
+    {
+        int size = cipher_get_hint(it)
+                       ? (int)strlen(cipher_get_hint(it))
+                       : 0;
+        sqlite3_bind_text(stmt, col + 6, cipher_get_hint(it), size, SQLITE_STATIC);
+    }
+}
+
+int c_sqlite_add_info(c_sqlite_s *ctx, const c_info_s *in)
+{
+    assert(ctx);
+    assert(in);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_ADD_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    c_info_foreach(it, in)
+    {
+        if (cipher_get_text(it))
+        {
+            sqlite3_reset(stmt);
+            c_sqlite_bind_info(stmt, 0, it);
+            sqlite3_step(stmt);
+        }
+    }
+
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_del_word(c_sqlite_s *ctx, const c_word_s *in)
+{
+    assert(ctx);
+    assert(in);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_DEL_WORD, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    c_word_foreach(it, in)
+    {
+        if (str_len(it))
+        {
+            sqlite3_reset(stmt);
+            sqlite3_bind_text(stmt, 1, str_val(it), (int)str_len(it), SQLITE_STATIC);
+            sqlite3_step(stmt);
+        }
+    }
+
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_del_info(c_sqlite_s *ctx, const c_info_s *in)
+{
+    assert(ctx);
+    assert(in);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_DEL_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    c_info_foreach(it, in)
+    {
+        if (cipher_get_text(it))
+        {
+            sqlite3_reset(stmt);
             sqlite3_bind_text(stmt, 1, cipher_get_text(it), (int)strlen(cipher_get_text(it)), SQLITE_STATIC);
             sqlite3_step(stmt);
         }
     }
 
-    return sqlite3_finalize(stmt);
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_get_info(c_sqlite_s *ctx, cstr_t text, cipher_s *out)
+{
+    assert(ctx);
+    assert(text);
+    assert(out);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_GET_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+    ok = sqlite3_step(stmt);
+    if (ok == SQLITE_ROW)
+    {
+        c_sqlite_row_info(stmt, out, 0);
+    }
+
+    int ret = sqlite3_reset(stmt);
+    return ok == SQLITE_DONE ? SQLITE_NOTFOUND : ret;
+}
+
+int c_sqlite_page_info(c_sqlite_s *ctx, size_t idx, size_t num, c_info_s *out)
+{
+    assert(ctx);
+    assert(out);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_PAGE_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    c_arena_s *arena = c_info_arena(out);
+    sqlite3_bind_int64(stmt, 1, (sqlite3_int64)num);
+    sqlite3_bind_int64(stmt, 2, (sqlite3_int64)idx);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        c_sqlite_row_info(stmt, c_info_push(out), arena);
+    }
+
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_put_word(c_sqlite_s *ctx, cstr_t text)
+{
+    assert(ctx);
+    assert(text);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_PUT_WORD, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+    sqlite3_step(stmt);
+
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_remove_word(c_sqlite_s *ctx, cstr_t text)
+{
+    assert(ctx);
+    assert(text);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_DEL_WORD, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+    sqlite3_step(stmt);
+
+    ok = sqlite3_reset(stmt);
+    return ok == SQLITE_OK && sqlite3_changes(ctx->db) == 0 ? SQLITE_NOTFOUND : ok;
+}
+
+int c_sqlite_put_info(c_sqlite_s *ctx, const cipher_s *in)
+{
+    assert(ctx);
+    assert(in);
+    assert(cipher_get_text(in));
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_PUT_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    c_sqlite_bind_info(stmt, 0, in);
+    sqlite3_step(stmt);
+
+    return sqlite3_reset(stmt);
+}
+
+int c_sqlite_remove_info(c_sqlite_s *ctx, cstr_t text)
+{
+    assert(ctx);
+    assert(text);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_DEL_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+    sqlite3_step(stmt);
+
+    ok = sqlite3_reset(stmt);
+    return ok == SQLITE_OK && sqlite3_changes(ctx->db) == 0 ? SQLITE_NOTFOUND : ok;
+}
+
+/* the position of the first text not less than text, and the walk of the index from there */
+static int c_sqlite_seek_info_(c_sqlite_s *ctx, const void *text, int size, size_t *pos, sqlite3_stmt **walk)
+{
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_RANK_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+    sqlite3_bind_text(stmt, 1, (const char *)text, size, SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        sqlite3_int64 num = sqlite3_column_int64(stmt, 0);
+        *pos = num > 0 ? (size_t)num : 0;
+    }
+    ok = sqlite3_reset(stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+    ok = c_sqlite_stmt_(ctx, C_SQLITE_WALK_INFO, walk);
+    if (ok == SQLITE_OK)
+    {
+        /* the walk outlives the row of text */
+        sqlite3_bind_text(*walk, 1, (const char *)text, size, SQLITE_TRANSIENT);
+    }
+    return ok;
+}
+
+/*
+ The rows of stmt are in the order of their text. The position of the first
+ row is the number of texts before it, the positions of the others are found
+ by walking the index of text from there along with them. The walk reads the
+ index once and never the rows.
+*/
+static int c_sqlite_each_info_(c_sqlite_s *ctx, sqlite3_stmt *stmt, c_sqlite_info_f func, void *arg)
+{
+    size_t pos = 0;
+    sqlite3_stmt *walk = 0;
+    int ok = SQLITE_OK, has = 0;
+    while (sqlite3_step(stmt) == SQLITE_ROW)
+    {
+        const void *text = sqlite3_column_text(stmt, 0);
+        int size = sqlite3_column_bytes(stmt, 0);
+        if (walk == 0)
+        {
+            ok = c_sqlite_seek_info_(ctx, text, size, &pos, &walk);
+            if (ok != SQLITE_OK)
+            {
+                break;
+            }
+            has = sqlite3_step(walk) == SQLITE_ROW;
+        }
+        while (has && (sqlite3_column_bytes(walk, 0) != size ||
+                       memcmp(sqlite3_column_text(walk, 0), text, (size_t)size)))
+        {
+            has = sqlite3_step(walk) == SQLITE_ROW;
+            ++pos;
+        }
+
+        cipher_s it[1];
+        cipher_ctor(it);
+        c_sqlite_row_info(stmt, it, 0);
+        int stop = func(arg, pos, it);
+        cipher_dtor(it);
+        if (stop)
+        {
+            break;
+        }
+    }
+    if (walk)
+    {
+        sqlite3_reset(walk);
+    }
+    int ret = sqlite3_reset(stmt);
+    return ok == SQLITE_OK ? ret : ok;
+}
+
+int c_sqlite_prefix_info(c_sqlite_s *ctx, cstr_t str, c_sqlite_info_f func, void *arg)
+{
+    assert(ctx);
+    assert(str);
+    assert(func);
+    sqlite3_stmt *stmt;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_PREFIX_INFO, &stmt);
+    if (ok != SQLITE_OK)
+    {
+        return ok;
+    }
+
+    /* the texts that start with str are those from str up to the next string of the same length */
+    size_t len = strlen(str);
+    sqlite3_bind_text(stmt, 1, str, (int)len, SQLITE_STATIC);
+    while (len && (byte_t)str[len - 1] == 0xFF)
+    {
+        --len;
+    }
+    if (len)
+    {
+        char *end = (char *)sqlite3_malloc64(len);
+        memcpy(end, str, len);
+        ++end[len - 1];
+        sqlite3_bind_text(stmt, 2, end, (int)len, sqlite3_free);
+    }
+    else
+    {
+        /* every text is less than a blob */
+        sqlite3_bind_zeroblob(stmt, 2, 0);
+    }
+
+    return c_sqlite_each_info_(ctx, stmt, func, arg);
+}
+
+/* the number of characters of a string of UTF-8, counted up to max */
+static size_t c_sqlite_chars_(cstr_t str, size_t max)
+{
+    size_t num = 0;
+    for (; *str && num != max; ++str)
+    {
+        /* every byte but a continuation byte starts a character */
+        num += ((byte_t)*str & 0xC0) != 0x80;
+    }
+    return num;
+}
+
+int c_sqlite_match_info(c_sqlite_s *ctx, cstr_t str, c_sqlite_info_f func, void *arg)
+{
+    assert(ctx);
+    assert(str);
+    assert(func);
+    sqlite3_stmt *stmt = 0;
+
+    /* a trigram index can not find fewer than three characters, without the index the table is scanned */
+    if (c_sqlite_chars_(str, 3) == 3 && c_sqlite_stmt_(ctx, C_SQLITE_MATCH_INFO, &stmt) == SQLITE_OK)
+    {
+        /* str is one phrase, a double quote in it is doubled */
+        sqlite3_str *q = sqlite3_str_new(ctx->db);
+        sqlite3_str_appendchar(q, 1, '"');
+        for (cstr_t s = str; *s; ++s)
+        {
+            sqlite3_str_appendchar(q, *s == '"' ? 2 : 1, *s);
+        }
+        sqlite3_str_appendchar(q, 1, '"');
+        int len = sqlite3_str_length(q);
+        sqlite3_bind_text(stmt, 1, sqlite3_str_finish(q), len, sqlite3_free);
+    }
+    else
+    {
+        int ok = c_sqlite_stmt_(ctx, C_SQLITE_SCAN_INFO, &stmt);
+        if (ok != SQLITE_OK)
+        {
+            return ok;
+        }
+        sqlite3_bind_text(stmt, 1, str, -1, SQLITE_STATIC);
+    }
+
+    return c_sqlite_each_info_(ctx, stmt, func, arg);
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/* the rows of one table for a bulk load */
+typedef struct c_sqlite_load_s
+{
+    int (*has)(const void *in, size_t idx); /* whether the entry at idx is written */
+    void (*bind)(sqlite3_stmt *stmt, int col, const void *in, size_t idx);
+    c_sqlite_e many; /* the statement of as many rows as it can take */
+    c_sqlite_e one; /* the statement of one row */
+    int cols;
+} c_sqlite_load_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+static int c_sqlite_load_(c_sqlite_s *ctx, const c_sqlite_load_s *load, const void *in, size_t num,
+                          size_t chunk, c_sqlite_chunk_f func, void *arg)
+{
+    int ret = SQLITE_OK;
+    int rows = c_sqlite_rows_(ctx->db, load->cols);
+    if (chunk == 0)
+    {
+        chunk = num;
+    }
+    for (size_t idx = 0; idx < num; idx += chunk)
+    {
+        size_t end = num - idx > chunk ? idx + chunk : num;
+        /* a savepoint out of a transaction begins and commits one */
+        int ok = c_sqlite_exec_(ctx, C_SQLITE_SAVE);
+        if (ok == SQLITE_OK)
+        {
+            /* the entries fill the rows of the statement, those left over go one by one */
+            size_t from = idx;
+            sqlite3_stmt *stmt;
+            ok = c_sqlite_stmt_(ctx, load->many, &stmt);
+            for (size_t i = idx, row = 0; ok == SQLITE_OK && i != end; ++i)
+            {
+                if (load->has(in, i))
+                {
+                    load->bind(stmt, (int)row * load->cols, in, i);
+                    if (++row == (size_t)rows)
+                    {
+                        sqlite3_step(stmt);
+                        ok = sqlite3_reset(stmt);
+                        from = i + 1;
+                        row = 0;
+                    }
+                }
+            }
+            if (ok == SQLITE_OK)
+            {
+                ok = c_sqlite_stmt_(ctx, load->one, &stmt);
+            }
+            for (size_t i = from; ok == SQLITE_OK && i != end; ++i)
+            {
+                if (load->has(in, i))
+                {
+                    sqlite3_reset(stmt);
+                    load->bind(stmt, 0, in, i);
+                    sqlite3_step(stmt);
+                    ok = sqlite3_reset(stmt);
+                }
+            }
+            if (ok != SQLITE_OK)
+            {
+                c_sqlite_exec_(ctx, C_SQLITE_ROLLBACK);
+                c_sqlite_exec_(ctx, C_SQLITE_RELEASE);
+            }
+            else
+            {
+                ok = c_sqlite_exec_(ctx, C_SQLITE_RELEASE);
+            }
+        }
+        ret = ret == SQLITE_OK ? ok : ret;
+        if (func && func(arg, idx, end - idx, ok))
+        {
+            break;
+        }
+    }
+    return ret;
+}
+
+static int c_sqlite_has_word_(const void *in, size_t idx)
+{
+    return str_len(c_word_at((const c_word_s *)in, idx)) != 0;
+}
+
+static void c_sqlite_bind_word_(sqlite3_stmt *stmt, int col, const void *in, size_t idx)
+{
+    const str_s *it = c_word_at((const c_word_s *)in, idx);
+    sqlite3_bind_text(stmt, col + 1, str_val(it), (int)str_len(it), SQLITE_STATIC);
+}
+
+static int c_sqlite_has_info_(const void *in, size_t idx)
+{
+    return cipher_get_text(c_info_at((const c_info_s *)in, idx)) != 0;
+}
+
+static void c_sqlite_bind_info_(sqlite3_stmt *stmt, int col, const void *in, size_t idx)
+{
+    c_sqlite_bind_info(stmt, col, c_info_at((const c_info_s *)in, idx));
+}
+
+int c_sqlite_load_word(c_sqlite_s *ctx, const c_word_s *in, size_t chunk, c_sqlite_chunk_f func, void *arg)
+{
+    assert(ctx);
+    assert(in);
+    static const c_sqlite_load_s load = {
+        c_sqlite_has_word_,
+        c_sqlite_bind_word_,
+        C_SQLITE_LOAD_WORD,
+        C_SQLITE_PUT_WORD,
+        1,
+    };
+    return c_sqlite_load_(ctx, &load, in, c_word_num(in), chunk, func, arg);
+}
+
+int c_sqlite_load_info(c_sqlite_s *ctx, const c_info_s *in, size_t chunk, c_sqlite_chunk_f func, void *arg)
+{
+    assert(ctx);
+    assert(in);
+    static const c_sqlite_load_s load = {
+        c_sqlite_has_info_,
+        c_sqlite_bind_info_,
+        C_SQLITE_LOAD_INFO,
+        C_SQLITE_PUT_INFO,
+        6,
+    };
+    /* building the full text index again beats keeping it up to date row by row */
+    size_t num = c_info_num(in);
+    int fts = num >= c_sqlite_count_info(ctx) >> 2 && c_sqlite_has_fts_(ctx);
+    if (fts)
+    {
+        c_sqlite_delete_fts_(ctx);
+    }
+    int ok = c_sqlite_load_(ctx, &load, in, num, chunk, func, arg);
+    if (fts)
+    {
+        c_sqlite_create_fts_(ctx);
+    }
+    return ok;
+}
+
+static int c_sqlite_apply_word(c_sqlite_s *ctx, c_word_s *in)
+{
+    c_log_s *log = c_word_log(in);
+    if (c_log_is_all(log))
+    {
+        int ok = c_sqlite_delete_word(ctx);
+        if (ok == SQLITE_OK)
+        {
+            ok = c_sqlite_create_word(ctx);
+        }
+        if (ok == SQLITE_OK)
+        {
+            ok = c_sqlite_load_word(ctx, in, 0, 0, 0);
+        }
+        return ok;
+    }
+    sqlite3_stmt *add = 0, *del = 0;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_PUT_WORD, &add);
+    if (ok == SQLITE_OK)
+    {
+        ok = c_sqlite_stmt_(ctx, C_SQLITE_DEL_WORD, &del);
+    }
+
+    for (size_t i = 0; ok == SQLITE_OK && i != c_log_num(log); ++i)
+    {
+        /* a word that is still present is written, the others are deleted */
+        cstr_t key = c_log_key(log, i);
+        sqlite3_stmt *stmt = c_word_find(in, key) ? add : del;
+        sqlite3_reset(stmt);
+        sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+        sqlite3_step(stmt);
+        ok = sqlite3_reset(stmt);
+    }
+    return ok;
+}
+
+static int c_sqlite_apply_info(c_sqlite_s *ctx, c_info_s *in)
+{
+    c_log_s *log = c_info_log(in);
+    if (c_log_is_all(log))
+    {
+        int ok = c_sqlite_delete_info(ctx);
+        if (ok == SQLITE_OK)
+        {
+            ok = c_sqlite_create_info(ctx);
+        }
+        if (ok == SQLITE_OK)
+        {
+            ok = c_sqlite_load_info(ctx, in, 0, 0, 0);
+        }
+        return ok;
+    }
+    sqlite3_stmt *add = 0, *del = 0;
+    int ok = c_sqlite_stmt_(ctx, C_SQLITE_PUT_INFO, &add);
+    if (ok == SQLITE_OK)
+    {
+        ok = c_sqlite_stmt_(ctx, C_SQLITE_DEL_INFO, &del);
+    }
+
+    for (size_t i = 0; ok == SQLITE_OK && i != c_log_num(log); ++i)
+    {
+        /* an entry that is still present is written as it is now, the others are deleted */
+        cstr_t key = c_log_key(log, i);
+        const cipher_s *it = c_info_find(in, key);
+        sqlite3_stmt *stmt = it ? add : del;
+        sqlite3_reset(stmt);
+        if (it)
+        {
+            c_sqlite_bind_info(stmt, 0, it);
+        }
+        else
+        {
+            sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+        }
+        sqlite3_step(stmt);
+        ok = sqlite3_reset(stmt);
+    }
+    return ok;
+}
+
+int c_sqlite_apply_changes(c_sqlite_s *ctx, c_word_s *word, c_info_s *info)
+{
+    assert(ctx);
+    int ok = SQLITE_OK;
+    int begin = sqlite3_get_autocommit(ctx->db);
+    if (begin)
+    {
+        ok = c_sqlite_begin(ctx);
+    }
+    int has_word = word && (c_log_is_all(c_word_log(word)) || c_log_num(c_word_log(word)));
+    int has_info = info && (c_log_is_all(c_info_log(info)) || c_log_num(c_info_log(info)));
+    if (ok == SQLITE_OK && has_word)
+    {
+        ok = c_sqlite_apply_word(ctx, word);
+    }
+    if (ok == SQLITE_OK && has_info)
+    {
+        ok = c_sqlite_apply_info(ctx, info);
+    }
+    if (begin && ok == SQLITE_OK)
+    {
+        ok = c_sqlite_commit(ctx);
+    }
+    if (ok != SQLITE_OK)
+    {
+        /* the journals are kept until their changes are in the database */
+        if (begin && !sqlite3_get_autocommit(ctx->db))
+        {
+            c_sqlite_rollback(ctx);
+        }
+        return ok;
+    }
+    if (has_word)
+    {
+        c_log_drop(c_word_log(word));
+    }
+    if (has_info)
+    {
+        c_log_drop(c_info_log(info));
+    }
+    return ok;
 }
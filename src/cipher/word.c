@@ -8,38 +8,59 @@
 
 int c_word_add(c_word_s *ctx, str_s *obj)
 {
-    str_s *it = 0;
-    c_word_forenum(i, ctx)
+    /* a word that is already present is left untouched */
+    if (c_word_find(ctx, str_val(obj)))
     {
-        it = c_word_at(ctx, i);
-        if (str_val(it) && strcmp(str_val(it), str_val(obj)) == 0)
-        {
-            str_dtor(it);
-            break;
-        }
-        it = 0;
+        return SUCCESS;
     }
+    /* the word is copied first and the journal is marked last, so a failure changes nothing */
+    str_s tmp[1];
+    str_ctor(tmp);
+    int ok = str_copy(tmp, obj);
+    if (ok != SUCCESS)
+    {
+        str_dtor(tmp);
+        return ok;
+    }
+    /* a slot freed by c_word_del is reused first */
+    size_t num = c_word_num(ctx);
+    str_s *it = c_word_claim(ctx);
     if (it == 0)
     {
-        it = c_word_push(ctx);
-        str_ctor(it);
-        if (it == 0)
-        {
-            return FAILURE;
-        }
+        str_dtor(tmp);
+        return FAILURE;
     }
-    return str_copy(it, obj);
+    str_move(it, tmp);
+    ok = c_word_remember(ctx, it);
+    if (ok != SUCCESS)
+    {
+        c_word_unclaim(ctx, it);
+        return ok;
+    }
+    if (c_word_num(ctx) == num)
+    {
+        /* a word in a freed slot goes ahead of the later ones, which a new row does not */
+        c_log_all(c_word_log(ctx));
+    }
+    else
+    {
+        c_word_mark(ctx, str_val(it));
+    }
+    return SUCCESS;
 }
 
 int c_word_del(c_word_s *ctx, str_s *obj)
 {
+    /* the slot is freed in place, so the indices of later words are kept */
     int ret = FAILURE;
-    c_word_foreach(it, ctx)
+    str_s *it;
+    while ((it = c_word_find(ctx, str_val(obj))) != NULL)
     {
-        if (str_val(it) && strcmp(str_val(it), str_val(obj)) == 0)
+        c_word_erase(ctx, (size_t)(it - c_word_ptr(ctx)));
+        ret = SUCCESS;
+        if (it == obj)
         {
-            str_dtor(it);
-            ret = SUCCESS;
+            break;
         }
     }
     return ret;
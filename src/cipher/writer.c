@@ -0,0 +1,608 @@
+/*!
+ @file writer.c
+ @brief cipher background writer
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#if defined(HAS_PTHREAD_H)
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif /* HAS_PTHREAD_H */
+
+#include "cipher/writer.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(HAS_PTHREAD_H)
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#endif /* HAS_PTHREAD_H */
+
+/* a word change is even and the info change of the same kind follows it */
+enum
+{
+    C_WRITER_PUT_WORD,
+    C_WRITER_DEL_WORD,
+    C_WRITER_PUT_INFO,
+    C_WRITER_DEL_INFO,
+    C_WRITER_CLEAR_WORD,
+    C_WRITER_CLEAR_INFO,
+    C_WRITER_FLUSH,
+    C_WRITER_SKIP,
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+typedef struct c_writer_node_s
+{
+    struct c_writer_node_s *next;
+    cipher_s info[1]; /* the entry, or the word or the key in its text */
+    int *ok; /* where a flush takes the result */
+    size_t idx; /* the position in its batch */
+    unsigned int op;
+} c_writer_node_s;
+
+#if defined(HAS_PTHREAD_H)
+typedef struct c_writer_sync_s
+{
+    pthread_t thread;
+    pthread_mutex_t mutex[1];
+    pthread_cond_t wake[1]; /* the thread waits on it for changes */
+    pthread_cond_t idle[1]; /* the flushes wait on it to be written */
+    int flush; /* number of flushes that wait */
+} c_writer_sync_s;
+#endif /* HAS_PTHREAD_H */
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+/* the queue is a stack that is taken whole, so a push never waits and there is no ABA */
+#if defined(__GNUC__) || defined(__clang__)
+#define C_WRITER_CAS(ptr, cmp, val) __atomic_compare_exchange_n(ptr, cmp, val, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)
+#define C_WRITER_XCHG(ptr, val) __atomic_exchange_n(ptr, val, __ATOMIC_ACQUIRE)
+#define C_WRITER_ADD(ptr, val) __atomic_add_fetch(ptr, val, __ATOMIC_RELAXED)
+#define C_WRITER_SUB(ptr, val) __atomic_sub_fetch(ptr, val, __ATOMIC_RELAXED)
+#define C_WRITER_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#else /* !__GNUC__ */
+/* without atomics, the changes are queued from one thread */
+#define C_WRITER_CAS(ptr, cmp, val) (*(ptr) = (val), 1)
+#define C_WRITER_XCHG(ptr, val) c_writer_xchg_(ptr, val)
+#define C_WRITER_ADD(ptr, val) (*(ptr) += (val))
+#define C_WRITER_SUB(ptr, val) (*(ptr) -= (val))
+#define C_WRITER_LOAD(ptr) (*(ptr))
+static c_writer_node_s *c_writer_xchg_(c_writer_node_s **ptr, c_writer_node_s *val)
+{
+    c_writer_node_s *old = *ptr;
+    *ptr = val;
+    return old;
+}
+#endif /* __GNUC__ */
+
+static int c_writer_cmp_(const void *lhs, const void *rhs)
+{
+    const c_writer_node_s *l = *(const c_writer_node_s *const *)lhs;
+    const c_writer_node_s *r = *(const c_writer_node_s *const *)rhs;
+    if ((l->op >> 1) != (r->op >> 1))
+    {
+        return (l->op >> 1) < (r->op >> 1) ? -1 : 1;
+    }
+    int ret = strcmp(cipher_get_text(l->info), cipher_get_text(r->info));
+    if (ret)
+    {
+        return ret;
+    }
+    return (l->idx > r->idx) - (l->idx < r->idx);
+}
+
+/* every change but the last of each key is skipped, a clear keeps its place between them */
+static void c_writer_coalesce_(c_writer_node_s *list, size_t num)
+{
+    c_writer_node_s **sort = (c_writer_node_s **)malloc(sizeof(c_writer_node_s *) * num);
+    if (sort == NULL)
+    {
+        return;
+    }
+    size_t n = 0;
+    for (size_t i = 0; list; list = list->next)
+    {
+        list->idx = i++;
+        if (list->op < C_WRITER_CLEAR_WORD)
+        {
+            sort[n++] = list;
+        }
+    }
+    qsort(sort, n, sizeof(c_writer_node_s *), c_writer_cmp_);
+    for (size_t i = 1; i < n; ++i)
+    {
+        if ((sort[i - 1]->op >> 1) == (sort[i]->op >> 1) &&
+            strcmp(cipher_get_text(sort[i - 1]->info), cipher_get_text(sort[i]->info)) == 0)
+        {
+            sort[i - 1]->op = C_WRITER_SKIP;
+        }
+    }
+    free(sort);
+}
+
+static int c_writer_exec_(c_sqlite_s *sql, const c_writer_node_s *node)
+{
+    int ok = SQLITE_OK;
+    switch (node->op)
+    {
+    case C_WRITER_PUT_WORD:
+        ok = c_sqlite_put_word(sql, cipher_get_text(node->info));
+        break;
+    case C_WRITER_DEL_WORD:
+        ok = c_sqlite_remove_word(sql, cipher_get_text(node->info));
+        break;
+    case C_WRITER_PUT_INFO:
+        ok = c_sqlite_put_info(sql, node->info);
+        break;
+    case C_WRITER_DEL_INFO:
+        ok = c_sqlite_remove_info(sql, cipher_get_text(node->info));
+        break;
+    case C_WRITER_CLEAR_WORD:
+        c_sqlite_delete_word(sql);
+        ok = c_sqlite_create_word(sql);
+        break;
+    case C_WRITER_CLEAR_INFO:
+        c_sqlite_delete_info(sql);
+        ok = c_sqlite_create_info(sql);
+        break;
+    default:
+        break;
+    }
+    /* a key that is gone already is deleted all the same */
+    return ok == SQLITE_NOTFOUND ? SQLITE_OK : ok;
+}
+
+/*
+ Write the changes of a failed batch and every queued change as one transaction,
+ the flushes are left in wait in order. A batch that failed on a lock is kept to
+ be written again with the next one, unless it is the last. Any other batch that
+ failed is given up, its error goes to the flushes.
+*/
+static int c_writer_write_(c_writer_s *ctx, c_writer_node_s **wait, int last)
+{
+    c_writer_node_s *head = C_WRITER_XCHG(&ctx->__head, NULL);
+    /* the queue holds the last change first */
+    c_writer_node_s *list = NULL;
+    size_t num = 0;
+    while (head)
+    {
+        c_writer_node_s *next = head->next;
+        head->next = list;
+        list = head;
+        head = next;
+        ++num;
+    }
+    C_WRITER_SUB(&ctx->__num, num);
+    if (ctx->__retry)
+    {
+        c_writer_node_s **tail = &ctx->__retry;
+        for (; *tail; tail = &(*tail)->next)
+        {
+            ++num;
+        }
+        *tail = list;
+        list = ctx->__retry;
+        ctx->__retry = NULL;
+    }
+    if (num == 0)
+    {
+        return SQLITE_OK;
+    }
+    c_writer_coalesce_(list, num);
+
+    c_writer_node_s *done = NULL, **tail = &done;
+    int ok = c_sqlite_begin(ctx->__sql);
+    while (list)
+    {
+        c_writer_node_s *next = list->next;
+        list->next = NULL;
+        if (list->op == C_WRITER_FLUSH)
+        {
+            *wait = list;
+            wait = &list->next;
+        }
+        else
+        {
+            if (ok == SQLITE_OK)
+            {
+                ok = c_writer_exec_(ctx->__sql, list);
+            }
+            *tail = list;
+            tail = &list->next;
+        }
+        list = next;
+    }
+    if (ok == SQLITE_OK)
+    {
+        ok = c_sqlite_commit(ctx->__sql);
+    }
+    if (ok != SQLITE_OK && !sqlite3_get_autocommit(c_sqlite_db(ctx->__sql)))
+    {
+        c_sqlite_rollback(ctx->__sql);
+    }
+
+    int again = !last && ((ok & 0xFF) == SQLITE_BUSY || (ok & 0xFF) == SQLITE_LOCKED);
+    tail = &ctx->__retry;
+    for (c_writer_node_s *next; done; done = next)
+    {
+        next = done->next;
+        if (again && done->op != C_WRITER_SKIP)
+        {
+            *tail = done;
+            tail = &done->next;
+        }
+        else
+        {
+            cipher_dtor(done->info);
+            free(done);
+        }
+    }
+    *tail = NULL;
+    return ok;
+}
+
+static void c_writer_drop_(c_writer_s *ctx)
+{
+    c_writer_node_s *list = ctx->__retry;
+    for (c_writer_node_s *next; list; list = next)
+    {
+        next = list->next;
+        cipher_dtor(list->info);
+        free(list);
+    }
+    ctx->__retry = NULL;
+}
+
+#if defined(HAS_PTHREAD_H)
+
+static void *c_writer_main_(void *arg)
+{
+    c_writer_s *ctx = (c_writer_s *)arg;
+    c_writer_sync_s *sync = (c_writer_sync_s *)ctx->__sync;
+    struct timespec due;
+    int timing = 0;
+
+    pthread_mutex_lock(sync->mutex);
+    for (;;)
+    {
+        /* a failed batch waits for the timer to be written again */
+        size_t num = C_WRITER_LOAD(&ctx->__num);
+        if (num == 0 && !ctx->__retry)
+        {
+            if (ctx->__stop)
+            {
+                break;
+            }
+            timing = 0;
+            pthread_cond_wait(sync->wake, sync->mutex);
+            continue;
+        }
+        if (num < ctx->__batch && sync->flush <= 0 && !ctx->__stop)
+        {
+            /* the timer starts with the first change of a batch */
+            if (!timing)
+            {
+                clock_gettime(CLOCK_REALTIME, &due);
+                due.tv_sec += (time_t)(ctx->__msec / 1000);
+                due.tv_nsec += (long)(ctx->__msec % 1000) * 1000000L;
+                if (due.tv_nsec >= 1000000000L)
+                {
+                    due.tv_nsec -= 1000000000L;
+                    ++due.tv_sec;
+                }
+                timing = 1;
+            }
+            if (pthread_cond_timedwait(sync->wake, sync->mutex, &due) != ETIMEDOUT)
+            {
+                continue;
+            }
+        }
+        timing = 0;
+        int last = ctx->__stop;
+        pthread_mutex_unlock(sync->mutex);
+        c_writer_node_s *wait = NULL;
+        int ok = c_writer_write_(ctx, &wait, last);
+        pthread_mutex_lock(sync->mutex);
+        ctx->__ok = ctx->__ok == SQLITE_OK ? ok : ctx->__ok;
+        if (wait)
+        {
+            /* a flush owns its node, it is gone once the mutex is released */
+            for (c_writer_node_s *next; wait; wait = next)
+            {
+                next = wait->next;
+                *wait->ok = ctx->__ok;
+                --sync->flush;
+            }
+            ctx->__ok = SQLITE_OK;
+            pthread_cond_broadcast(sync->idle);
+        }
+    }
+    pthread_mutex_unlock(sync->mutex);
+
+    return NULL;
+}
+
+#endif /* HAS_PTHREAD_H */
+
+static void c_writer_push_(c_writer_s *ctx, c_writer_node_s *node)
+{
+    node->next = C_WRITER_LOAD(&ctx->__head);
+    while (!C_WRITER_CAS(&ctx->__head, &node->next, node))
+    {
+    }
+    size_t num = C_WRITER_ADD(&ctx->__num, 1);
+#if defined(HAS_PTHREAD_H)
+    /* the first change starts the timer and a full batch is written at once */
+    if (num == 1 || num == ctx->__batch)
+    {
+        c_writer_sync_s *sync = (c_writer_sync_s *)ctx->__sync;
+        pthread_mutex_lock(sync->mutex);
+        pthread_cond_signal(sync->wake);
+        pthread_mutex_unlock(sync->mutex);
+    }
+#else /* !HAS_PTHREAD_H */
+    if (num >= ctx->__batch)
+    {
+        c_writer_node_s *wait = NULL;
+        int ok = c_writer_write_(ctx, &wait, 0);
+        ctx->__ok = ctx->__ok == SQLITE_OK ? ok : ctx->__ok;
+    }
+#endif /* HAS_PTHREAD_H */
+}
+
+static int c_writer_key_(c_writer_s *ctx, unsigned int op, cstr_t text)
+{
+    c_writer_node_s *node = (c_writer_node_s *)malloc(sizeof(c_writer_node_s));
+    if (node == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+    cipher_ctor(node->info);
+    if (text && cipher_set_text(node->info, text))
+    {
+        cipher_dtor(node->info);
+        free(node);
+        return SQLITE_NOMEM;
+    }
+    node->ok = NULL;
+    node->op = op;
+    c_writer_push_(ctx, node);
+    return SQLITE_OK;
+}
+
+int c_writer_open(c_writer_s *ctx, cstr_t path, size_t batch, unsigned int msec)
+{
+    assert(ctx);
+    assert(path);
+    ctx->__head = NULL;
+    ctx->__retry = NULL;
+    ctx->__sync = NULL;
+    ctx->__num = 0;
+    ctx->__batch = batch ? batch : 1;
+    ctx->__msec = msec;
+    ctx->__ok = SQLITE_OK;
+    ctx->__stop = 0;
+
+    int ok = c_sqlite_open(ctx->__sql, path, C_SQLITE_INTERACTIVE);
+    if (ok == SQLITE_OK)
+    {
+        ok = c_sqlite_create_word(ctx->__sql);
+    }
+    if (ok == SQLITE_OK)
+    {
+        ok = c_sqlite_create_info(ctx->__sql);
+    }
+#if defined(HAS_PTHREAD_H)
+    c_writer_sync_s *sync = NULL;
+    if (ok == SQLITE_OK)
+    {
+        sync = (c_writer_sync_s *)malloc(sizeof(c_writer_sync_s));
+        ok = sync ? SQLITE_OK : SQLITE_NOMEM;
+    }
+    if (ok == SQLITE_OK)
+    {
+        pthread_mutex_init(sync->mutex, NULL);
+        pthread_cond_init(sync->wake, NULL);
+        pthread_cond_init(sync->idle, NULL);
+        sync->flush = 0;
+        ctx->__sync = sync;
+        if (pthread_create(&sync->thread, NULL, c_writer_main_, ctx))
+        {
+            pthread_cond_destroy(sync->idle);
+            pthread_cond_destroy(sync->wake);
+            pthread_mutex_destroy(sync->mutex);
+            ctx->__sync = NULL;
+            ok = SQLITE_ERROR;
+        }
+    }
+    if (ok != SQLITE_OK)
+    {
+        free(sync);
+    }
+#endif /* HAS_PTHREAD_H */
+    if (ok != SQLITE_OK)
+    {
+        c_sqlite_close(ctx->__sql);
+    }
+    return ok;
+}
+
+int c_writer_close(c_writer_s *ctx)
+{
+    assert(ctx);
+#if defined(HAS_PTHREAD_H)
+    c_writer_sync_s *sync = (c_writer_sync_s *)ctx->__sync;
+    pthread_mutex_lock(sync->mutex);
+    ctx->__stop = 1;
+    pthread_cond_signal(sync->wake);
+    pthread_mutex_unlock(sync->mutex);
+    pthread_join(sync->thread, NULL);
+    pthread_cond_destroy(sync->idle);
+    pthread_cond_destroy(sync->wake);
+    pthread_mutex_destroy(sync->mutex);
+    free(sync);
+    ctx->__sync = NULL;
+    int ok = ctx->__ok;
+#else /* !HAS_PTHREAD_H */
+    c_writer_node_s *wait = NULL;
+    int ok = c_writer_write_(ctx, &wait, 1);
+    ok = ctx->__ok == SQLITE_OK ? ok : ctx->__ok;
+#endif /* HAS_PTHREAD_H */
+    c_writer_drop_(ctx);
+    c_sqlite_close(ctx->__sql);
+    return ok;
+}
+
+int c_writer_put_word(c_writer_s *ctx, cstr_t text)
+{
+    assert(ctx);
+    assert(text);
+    return c_writer_key_(ctx, C_WRITER_PUT_WORD, text);
+}
+
+int c_writer_del_word(c_writer_s *ctx, cstr_t text)
+{
+    assert(ctx);
+    assert(text);
+    return c_writer_key_(ctx, C_WRITER_DEL_WORD, text);
+}
+
+int c_writer_put_info(c_writer_s *ctx, const cipher_s *in)
+{
+    assert(ctx);
+    assert(in);
+    assert(cipher_get_text(in));
+    c_writer_node_s *node = (c_writer_node_s *)malloc(sizeof(c_writer_node_s));
+    if (node == NULL)
+    {
+        return SQLITE_NOMEM;
+    }
+    cipher_ctor(node->info);
+    if (cipher_copy(node->info, in))
+    {
+        cipher_dtor(node->info);
+        free(node);
+        return SQLITE_NOMEM;
+    }
+    node->ok = NULL;
+    node->op = C_WRITER_PUT_INFO;
+    c_writer_push_(ctx, node);
+    return SQLITE_OK;
+}
+
+int c_writer_del_info(c_writer_s *ctx, cstr_t text)
+{
+    assert(ctx);
+    assert(text);
+    return c_writer_key_(ctx, C_WRITER_DEL_INFO, text);
+}
+
+static int c_writer_apply_word(c_writer_s *ctx, c_word_s *in)
+{
+    int ok = SQLITE_OK;
+    c_log_s *log = c_word_log(in);
+    if (c_log_is_all(log))
+    {
+        ok = c_writer_key_(ctx, C_WRITER_CLEAR_WORD, NULL);
+        c_word_foreach(it, in)
+        {
+            if (ok == SQLITE_OK && str_len(it))
+            {
+                ok = c_writer_put_word(ctx, str_val(it));
+            }
+        }
+    }
+    for (size_t i = 0; ok == SQLITE_OK && i != c_log_num(log); ++i)
+    {
+        /* a word that is still present is written, the others are deleted */
+        cstr_t key = c_log_key(log, i);
+        ok = c_word_find(in, key) ? c_writer_put_word(ctx, key) : c_writer_del_word(ctx, key);
+    }
+    if (ok == SQLITE_OK)
+    {
+        c_log_drop(log);
+    }
+    return ok;
+}
+
+static int c_writer_apply_info(c_writer_s *ctx, c_info_s *in)
+{
+    int ok = SQLITE_OK;
+    c_log_s *log = c_info_log(in);
+    if (c_log_is_all(log))
+    {
+        ok = c_writer_key_(ctx, C_WRITER_CLEAR_INFO, NULL);
+        c_info_foreach(it, in)
+        {
+            if (ok == SQLITE_OK && cipher_get_text(it))
+            {
+                ok = c_writer_put_info(ctx, it);
+            }
+        }
+    }
+    for (size_t i = 0; ok == SQLITE_OK && i != c_log_num(log); ++i)
+    {
+        /* an entry that is still present is written as it is now, the others are deleted */
+        cstr_t key = c_log_key(log, i);
+        const cipher_s *it = c_info_find(in, key);
+        ok = it ? c_writer_put_info(ctx, it) : c_writer_del_info(ctx, key);
+    }
+    if (ok == SQLITE_OK)
+    {
+        c_log_drop(log);
+    }
+    return ok;
+}
+
+int c_writer_apply(c_writer_s *ctx, c_word_s *word, c_info_s *info)
+{
+    assert(ctx);
+    int ok = SQLITE_OK;
+    if (word)
+    {
+        ok = c_writer_apply_word(ctx, word);
+    }
+    if (info && ok == SQLITE_OK)
+    {
+        ok = c_writer_apply_info(ctx, info);
+    }
+    return ok;
+}
+
+int c_writer_flush(c_writer_s *ctx)
+{
+    assert(ctx);
+#if defined(HAS_PTHREAD_H)
+    c_writer_sync_s *sync = (c_writer_sync_s *)ctx->__sync;
+    /* every change queued before the node is written along with it or earlier */
+    int ok = -1;
+    c_writer_node_s node[1];
+    node->ok = &ok;
+    node->op = C_WRITER_FLUSH;
+    c_writer_push_(ctx, node);
+    pthread_mutex_lock(sync->mutex);
+    ++sync->flush;
+    pthread_cond_signal(sync->wake);
+    while (ok == -1)
+    {
+        pthread_cond_wait(sync->idle, sync->mutex);
+    }
+    pthread_mutex_unlock(sync->mutex);
+#else /* !HAS_PTHREAD_H */
+    c_writer_node_s *wait = NULL;
+    int ok = c_writer_write_(ctx, &wait, 0);
+    ok = ctx->__ok == SQLITE_OK ? ok : ctx->__ok;
+    ctx->__ok = SQLITE_OK;
+#endif /* HAS_PTHREAD_H */
+    return ok;
+}
@@ -0,0 +1,319 @@
+/*!
+ @file pbkdf2.c
+ @brief RFC 8018 compliant PBKDF2 implementation
+ @details https://www.ietf.org/rfc/rfc8018.txt
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#include "cksum/pbkdf2.h"
+
+#include "hash.h"
+
+#include <assert.h>
+#include <string.h>
+
+#undef HMAC_OPAD
+#define HMAC_OPAD 0x5C
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/* one output block of one password */
+typedef struct pbkdf2_lane_s
+{
+    const pbkdf2_s *key;
+    unsigned char *out;
+    size_t siz;
+    uint32_t index;
+    unsigned char t[HMAC_BUFSIZ];  /* xor of every U */
+    unsigned char ib[HMAC_BUFSIZ]; /* U, padded as the single block of the inner hash */
+    unsigned char ob[HMAC_BUFSIZ]; /* inner digest, padded as the single block of the outer hash */
+} pbkdf2_lane_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+/* one iteration, it turns U in ib into the next U */
+typedef void (*pbkdf2_f)(const pbkdf2_s *, unsigned char *, unsigned char *, hash_u *);
+
+static void pbkdf2_step(const pbkdf2_s *key, unsigned char *ib, unsigned char *ob, hash_u *ctx)
+{
+    const hash_s *hash = key->__hash;
+    memcpy(ctx, key->__inner, sizeof(hash_u));
+    hash->proc(ctx, ib, hash->outsiz);
+    hash->done(ctx, ob);
+    memcpy(ctx, key->__outer, sizeof(hash_u));
+    hash->proc(ctx, ob, hash->outsiz);
+    hash->done(ctx, ib);
+}
+
+/*
+ The message of both hashes in an iteration is one digest after the key
+ block, so its padding is known in advance. Each hash becomes a copy of
+ the chaining values and a single compression of the padded block,
+ skipping the buffering and the padding of the generic path.
+*/
+#undef PBKDF2_STEP
+#define PBKDF2_STEP(func, hash, proc, store)                                                 \
+    static void func(const pbkdf2_s *key, unsigned char *ib, unsigned char *ob, hash_u *ctx) \
+    {                                                                                        \
+        unsigned int n = sizeof(ctx->hash->__state) / sizeof(*ctx->hash->__state);           \
+        unsigned char u[sizeof(ctx->hash->__state)];                                         \
+        ctx->hash->__length = 0;                                                             \
+        ctx->hash->__cursiz = 0;                                                             \
+        memcpy(ctx->hash->__state, key->__inner->hash->__state, sizeof(u));                  \
+        proc(ctx->hash, ib, sizeof(ctx->hash->__buf));                                       \
+        for (unsigned int i = 0; i != n; ++i)                                                \
+        {                                                                                    \
+            store(ctx->hash->__state[i], u + sizeof(*ctx->hash->__state) * i);               \
+        }                                                                                    \
+        memcpy(ob, u, key->__hash->outsiz);                                                  \
+        memcpy(ctx->hash->__state, key->__outer->hash->__state, sizeof(u));                  \
+        proc(ctx->hash, ob, sizeof(ctx->hash->__buf));                                       \
+        for (unsigned int i = 0; i != n; ++i)                                                \
+        {                                                                                    \
+            store(ctx->hash->__state[i], u + sizeof(*ctx->hash->__state) * i);               \
+        }                                                                                    \
+        memcpy(ib, u, key->__hash->outsiz);                                                  \
+    }
+PBKDF2_STEP(pbkdf2_md5, md5, md5_proc, STORE32L)
+PBKDF2_STEP(pbkdf2_sha1, sha1, sha1_proc, STORE32H)
+PBKDF2_STEP(pbkdf2_sha256, sha256, sha256_proc, STORE32H)
+PBKDF2_STEP(pbkdf2_sha512, sha512, sha512_proc, STORE64H)
+#undef PBKDF2_STEP
+
+static const struct
+{
+    const hash_s *hash;
+    pbkdf2_f step;
+} pbkdf2_fast[] = {
+    {&hash_md5, pbkdf2_md5},
+    {&hash_sha1, pbkdf2_sha1},
+    {&hash_sha224, pbkdf2_sha256},
+    {&hash_sha256, pbkdf2_sha256},
+    {&hash_sha384, pbkdf2_sha512},
+    {&hash_sha512, pbkdf2_sha512},
+    {&hash_sha512_224, pbkdf2_sha512},
+    {&hash_sha512_256, pbkdf2_sha512},
+};
+
+static void pbkdf2_pad(const hash_s *hash, unsigned char *block)
+{
+    uint64_t length = (uint64_t)(hash->bufsiz + hash->outsiz) << 3;
+    memset(block + hash->outsiz, 0, hash->bufsiz - hash->outsiz);
+    block[hash->outsiz] = 0x80;
+    if (hash == &hash_md5)
+    {
+        STORE64L(length, block + hash->bufsiz - 8);
+    }
+    else
+    {
+        STORE64H(length, block + hash->bufsiz - 8);
+    }
+}
+
+static void pbkdf2_lanes(pbkdf2_lane_s *lane, unsigned int n, const void *psalt, size_t nsalt, size_t iter)
+{
+    const hash_s *hash = lane->key->__hash;
+    pbkdf2_f step = pbkdf2_step;
+    for (unsigned int i = 0; i != sizeof(pbkdf2_fast) / sizeof(*pbkdf2_fast); ++i)
+    {
+        if (pbkdf2_fast[i].hash == hash)
+        {
+            step = pbkdf2_fast[i].step;
+            break;
+        }
+    }
+
+    hash_u ctx[1];
+    for (unsigned int l = 0; l != n; ++l)
+    {
+        /* U1 = PRF(P, S || INT(i)) */
+        unsigned char index[4];
+        STORE32H(lane[l].index, index);
+        memcpy(ctx, lane[l].key->__inner, sizeof(hash_u));
+        hash->proc(ctx, psalt, nsalt);
+        hash->proc(ctx, index, sizeof(index));
+        hash->done(ctx, lane[l].ob);
+        memcpy(ctx, lane[l].key->__outer, sizeof(hash_u));
+        hash->proc(ctx, lane[l].ob, hash->outsiz);
+        hash->done(ctx, lane[l].ib);
+        memcpy(lane[l].t, lane[l].ib, hash->outsiz);
+        if (step != pbkdf2_step)
+        {
+            pbkdf2_pad(hash, lane[l].ib);
+            pbkdf2_pad(hash, lane[l].ob);
+        }
+    }
+    /* the lanes are independent chains, iterate them side by side */
+    for (size_t j = 1; j != iter; ++j)
+    {
+        for (unsigned int l = 0; l != n; ++l)
+        {
+            step(lane[l].key, lane[l].ib, lane[l].ob, ctx);
+            for (unsigned int i = 0; i != hash->outsiz; ++i)
+            {
+                lane[l].t[i] ^= lane[l].ib[i];
+            }
+        }
+    }
+    for (unsigned int l = 0; l != n; ++l)
+    {
+        memcpy(lane[l].out, lane[l].t, lane[l].siz);
+    }
+}
+
+int pbkdf2_init(pbkdf2_s *ctx, const hash_s *hash, const void *pdata, size_t nbyte)
+{
+    assert(ctx);
+    assert(hash);
+    assert(!nbyte || pdata);
+
+    hmac_s hmac[1];
+    int ret = hmac_init(hmac, hash, pdata, nbyte);
+    if (ret != SUCCESS)
+    {
+        return ret;
+    }
+    memcpy(ctx->__inner, hmac->__state, sizeof(hash_u));
+
+    /* hmac_init keeps the padded key in its buffer */
+    for (unsigned int i = 0; i != hash->bufsiz; ++i)
+    {
+        hmac->buf[i] ^= HMAC_OPAD;
+    }
+    hash->init(ctx->__outer);
+    ret = hash->proc(ctx->__outer, hmac->buf, hash->bufsiz);
+    ctx->__hash = hash;
+
+    return ret;
+}
+
+int pbkdf2_done(const pbkdf2_s *ctx, const void *psalt, size_t nsalt, size_t iter, void *out, size_t siz)
+{
+    assert(ctx);
+    assert(!siz || out);
+    assert(!nsalt || psalt);
+
+    const hash_s *hash = ctx->__hash;
+    if (iter == 0)
+    {
+        return INVALID;
+    }
+    if (siz && (siz - 1) / hash->outsiz >= 0xFFFFFFFF)
+    {
+        return OVERFLOW;
+    }
+
+    unsigned int n = 0;
+    pbkdf2_lane_s lane[PBKDF2_LANES];
+    unsigned char *o = (unsigned char *)out;
+    for (uint32_t i = 1; siz; ++i)
+    {
+        lane[n].key = ctx;
+        lane[n].out = o;
+        lane[n].siz = siz < hash->outsiz ? siz : hash->outsiz;
+        lane[n].index = i;
+        o += lane[n].siz;
+        siz -= lane[n].siz;
+        if (++n == PBKDF2_LANES)
+        {
+            pbkdf2_lanes(lane, n, psalt, nsalt, iter);
+            n = 0;
+        }
+    }
+    if (n)
+    {
+        pbkdf2_lanes(lane, n, psalt, nsalt, iter);
+    }
+
+    return SUCCESS;
+}
+
+int pbkdf2(const hash_s *hash, const void *pkey, size_t nkey, const void *psalt, size_t nsalt, size_t iter, void *out, size_t siz)
+{
+    assert(hash);
+
+    pbkdf2_s ctx[1];
+    int ret = pbkdf2_init(ctx, hash, pkey, nkey);
+    if (ret != SUCCESS)
+    {
+        return ret;
+    }
+
+    return pbkdf2_done(ctx, psalt, nsalt, iter, out, siz);
+}
+
+int pbkdf2_multi(const hash_s *hash, const void *const *pkey, const size_t *nkey, size_t count,
+                 const void *psalt, size_t nsalt, size_t iter, void *out, size_t siz)
+{
+    assert(hash);
+    assert(!count || (pkey && nkey));
+    assert(!count || !siz || out);
+    assert(!nsalt || psalt);
+
+    if (iter == 0)
+    {
+        return INVALID;
+    }
+    if (siz && (siz - 1) / hash->outsiz >= 0xFFFFFFFF)
+    {
+        return OVERFLOW;
+    }
+    if (siz == 0)
+    {
+        /* no block is derived, so no batch would ever give its key states back */
+        return SUCCESS;
+    }
+
+    /* a key state is set up once per password and shared by its lanes, so blocks of
+       different passwords can share a batch, there are never more keys than lanes */
+    unsigned int n = 0;
+    unsigned int keys = 0;
+    pbkdf2_s key[PBKDF2_LANES];
+    pbkdf2_lane_s lane[PBKDF2_LANES];
+    unsigned char *o = (unsigned char *)out;
+    for (size_t k = 0; k != count; ++k)
+    {
+        unsigned int cur = keys++;
+        int ret = pbkdf2_init(key + cur, hash, pkey[k], nkey[k]);
+        if (ret != SUCCESS)
+        {
+            return ret;
+        }
+        size_t left = siz;
+        for (uint32_t i = 1; left; ++i)
+        {
+            lane[n].key = key + cur;
+            lane[n].out = o;
+            lane[n].siz = left < hash->outsiz ? left : hash->outsiz;
+            lane[n].index = i;
+            o += lane[n].siz;
+            left -= lane[n].siz;
+            if (++n == PBKDF2_LANES)
+            {
+                pbkdf2_lanes(lane, n, psalt, nsalt, iter);
+                n = 0;
+                keys = 0;
+                if (left)
+                {
+                    /* the rest of the password goes on in the next batch */
+                    key[0] = key[cur];
+                    cur = 0;
+                    keys = 1;
+                }
+            }
+        }
+    }
+    if (n)
+    {
+        pbkdf2_lanes(lane, n, psalt, nsalt, iter);
+    }
+
+    return SUCCESS;
+}
+
+#undef HMAC_OPAD
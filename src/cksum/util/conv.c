@@ -9,6 +9,16 @@
 #include <assert.h>
 #include <ctype.h>
 
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#undef CONV_X86
+#define CONV_X86
+#include <immintrin.h>
+#undef CONV_SSSE3
+#define CONV_SSSE3 __attribute__((target("ssse3")))
+#undef CONV_AVX2
+#define CONV_AVX2 __attribute__((target("avx2")))
+#endif /* __x86_64__ || __i386__ */
+
 int xdigit(int x)
 {
     int ret = ~0;
@@ -79,36 +89,279 @@ TO(lower, tolower)
 TO(upper, toupper)
 #undef TO
 
-void *digest(const void *pdata, size_t nbyte, unsigned int cases, void *out)
+static const char hexits[2][0x10] = {
+    /* clang-format off */
+    {
+        '0', '1', '2', '3', '4', '5', '6', '7',
+        '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+    },
+    {
+        '0', '1', '2', '3', '4', '5', '6', '7',
+        '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
+    },
+    /* clang-format on */
+};
+
+typedef char *(*encode_f)(const unsigned char *, size_t, const char *, char *);
+typedef int (*decode_f)(const unsigned char *, size_t, unsigned char *);
+
+static char *encode(const unsigned char *p, size_t n, const char *hexit, char *o)
+{
+    for (const unsigned char *e = p + n; p != e; ++p)
+    {
+        *o++ = hexit[*p >> 0x4];
+        *o++ = hexit[*p & 0x0F];
+    }
+    return o;
+}
+
+/* two hexadecimal characters per byte */
+static int decode(const unsigned char *p, size_t n, unsigned char *o)
+{
+    for (const unsigned char *e = p + n; p != e; p += 2)
+    {
+        int h = xdigit(p[0]);
+        int l = xdigit(p[1]);
+        if ((h | l) < 0)
+        {
+            return ~0;
+        }
+        *o++ = (unsigned char)(h << 4 | l);
+    }
+    return 0;
+}
+
+/* one value per hexadecimal character */
+static int nibble(const unsigned char *p, size_t n, unsigned char *o)
 {
-    static const char hexits[2][0x10] = {
-        /* clang-format off */
+    for (const unsigned char *e = p + n; p != e; ++p)
+    {
+        int x = xdigit(*p);
+        if (x < 0)
         {
-            '0', '1', '2', '3', '4', '5', '6', '7',
-            '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
-        },
+            return ~0;
+        }
+        *o++ = (unsigned char)x;
+    }
+    return 0;
+}
+
+#if defined(CONV_X86)
+
+/*
+ encode splits every byte into its two nibbles and looks them up in the
+ sixteen hexits with pshufb, then interleaves the high and low characters.
+*/
+CONV_SSSE3 static char *encode_ssse3(const unsigned char *p, size_t n, const char *hexit, char *o)
+{
+    const __m128i lut = _mm_loadu_si128((const __m128i *)hexit);
+    const __m128i m4 = _mm_set1_epi8(0x0F);
+    for (; n >= 0x10; n -= 0x10, p += 0x10, o += 0x20)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *)p);
+        __m128i h = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(x, 4), m4));
+        __m128i l = _mm_shuffle_epi8(lut, _mm_and_si128(x, m4));
+        _mm_storeu_si128((__m128i *)o + 0, _mm_unpacklo_epi8(h, l));
+        _mm_storeu_si128((__m128i *)o + 1, _mm_unpackhi_epi8(h, l));
+    }
+    return encode(p, n, hexit, o);
+}
+
+CONV_AVX2 static char *encode_avx2(const unsigned char *p, size_t n, const char *hexit, char *o)
+{
+    const __m256i lut = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)hexit));
+    const __m256i m4 = _mm256_set1_epi8(0x0F);
+    for (; n >= 0x20; n -= 0x20, p += 0x20, o += 0x40)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i h = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), m4));
+        __m256i l = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, m4));
+        /* the unpacks work within 128-bit lanes, put the lanes back in order */
+        __m256i a = _mm256_unpacklo_epi8(h, l);
+        __m256i b = _mm256_unpackhi_epi8(h, l);
+        _mm256_storeu_si256((__m256i *)o + 0, _mm256_permute2x128_si256(a, b, 0x20));
+        _mm256_storeu_si256((__m256i *)o + 1, _mm256_permute2x128_si256(a, b, 0x31));
+    }
+    return encode_ssse3(p, n, hexit, o);
+}
+
+/*
+ decode maps '0'-'9' to 0 ~ 9 and 'a'-'f' or 'A'-'F' to 10 ~ 15,
+ every other character leaves a zero in the mask of valid lanes.
+*/
+CONV_SSSE3 static __m128i xdigit_ssse3(__m128i x, __m128i *ok)
+{
+    __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+    __m128i a = _mm_sub_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i isd = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    __m128i isa = _mm_cmpeq_epi8(_mm_min_epu8(a, _mm_set1_epi8(5)), a);
+    *ok = _mm_and_si128(*ok, _mm_or_si128(isd, isa));
+    a = _mm_add_epi8(a, _mm_set1_epi8(10));
+    return _mm_or_si128(_mm_and_si128(isd, d), _mm_andnot_si128(isd, a));
+}
+
+CONV_AVX2 static __m256i xdigit_avx2(__m256i x, __m256i *ok)
+{
+    __m256i d = _mm256_sub_epi8(x, _mm256_set1_epi8('0'));
+    __m256i a = _mm256_sub_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+    __m256i isd = _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    __m256i isa = _mm256_cmpeq_epi8(_mm256_min_epu8(a, _mm256_set1_epi8(5)), a);
+    *ok = _mm256_and_si256(*ok, _mm256_or_si256(isd, isa));
+    a = _mm256_add_epi8(a, _mm256_set1_epi8(10));
+    return _mm256_blendv_epi8(a, d, isd);
+}
+
+CONV_SSSE3 static int decode_ssse3(const unsigned char *p, size_t n, unsigned char *o)
+{
+    /* high nibble times 16 plus low nibble, for every pair of characters */
+    const __m128i w = _mm_set1_epi16(0x0110);
+    for (; n >= 0x20; n -= 0x20, p += 0x20, o += 0x10)
+    {
+        __m128i ok = _mm_set1_epi8(-1);
+        __m128i x0 = xdigit_ssse3(_mm_loadu_si128((const __m128i *)p + 0), &ok);
+        __m128i x1 = xdigit_ssse3(_mm_loadu_si128((const __m128i *)p + 1), &ok);
+        if (_mm_movemask_epi8(ok) != 0xFFFF)
         {
-            '0', '1', '2', '3', '4', '5', '6', '7',
-            '8', '9', 'A', 'B', 'C', 'D', 'E', 'F',
-        },
-        /* clang-format on */
-    };
+            return ~0;
+        }
+        x0 = _mm_maddubs_epi16(x0, w);
+        x1 = _mm_maddubs_epi16(x1, w);
+        _mm_storeu_si128((__m128i *)o, _mm_packus_epi16(x0, x1));
+    }
+    return decode(p, n, o);
+}
 
+CONV_AVX2 static int decode_avx2(const unsigned char *p, size_t n, unsigned char *o)
+{
+    const __m256i w = _mm256_set1_epi16(0x0110);
+    for (; n >= 0x40; n -= 0x40, p += 0x40, o += 0x20)
+    {
+        __m256i ok = _mm256_set1_epi8(-1);
+        __m256i x0 = xdigit_avx2(_mm256_loadu_si256((const __m256i *)p + 0), &ok);
+        __m256i x1 = xdigit_avx2(_mm256_loadu_si256((const __m256i *)p + 1), &ok);
+        if (_mm256_movemask_epi8(ok) != -1)
+        {
+            return ~0;
+        }
+        x0 = _mm256_maddubs_epi16(x0, w);
+        x1 = _mm256_maddubs_epi16(x1, w);
+        /* the pack works within 128-bit lanes, put the quadwords back in order */
+        x0 = _mm256_permute4x64_epi64(_mm256_packus_epi16(x0, x1), 0xD8);
+        _mm256_storeu_si256((__m256i *)o, x0);
+    }
+    return decode_ssse3(p, n, o);
+}
+
+CONV_SSSE3 static int nibble_ssse3(const unsigned char *p, size_t n, unsigned char *o)
+{
+    for (; n >= 0x10; n -= 0x10, p += 0x10, o += 0x10)
+    {
+        __m128i ok = _mm_set1_epi8(-1);
+        __m128i x = xdigit_ssse3(_mm_loadu_si128((const __m128i *)p), &ok);
+        if (_mm_movemask_epi8(ok) != 0xFFFF)
+        {
+            return ~0;
+        }
+        _mm_storeu_si128((__m128i *)o, x);
+    }
+    return nibble(p, n, o);
+}
+
+CONV_AVX2 static int nibble_avx2(const unsigned char *p, size_t n, unsigned char *o)
+{
+    for (; n >= 0x20; n -= 0x20, p += 0x20, o += 0x20)
+    {
+        __m256i ok = _mm256_set1_epi8(-1);
+        __m256i x = xdigit_avx2(_mm256_loadu_si256((const __m256i *)p), &ok);
+        if (_mm256_movemask_epi8(ok) != -1)
+        {
+            return ~0;
+        }
+        _mm256_storeu_si256((__m256i *)o, x);
+    }
+    return nibble_ssse3(p, n, o);
+}
+
+#undef CONV_PICK
+#define CONV_PICK(func, type)                \
+    static type func##_pick(void)            \
+    {                                        \
+        if (__builtin_cpu_supports("avx2"))  \
+        {                                    \
+            return func##_avx2;              \
+        }                                    \
+        if (__builtin_cpu_supports("ssse3")) \
+        {                                    \
+            return func##_ssse3;             \
+        }                                    \
+        return func;                         \
+    }
+#else /* !CONV_X86 */
+#undef CONV_PICK
+#define CONV_PICK(func, type)     \
+    static type func##_pick(void) \
+    {                             \
+        return func;              \
+    }
+#endif /* CONV_X86 */
+CONV_PICK(encode, encode_f)
+CONV_PICK(decode, decode_f)
+CONV_PICK(nibble, decode_f)
+#undef CONV_PICK
+
+char *hex_encode(const void *pdata, size_t nbyte, unsigned int cases, void *out)
+{
+    assert(!nbyte || pdata);
+    assert(!nbyte || out);
+    return encode_pick()((const unsigned char *)pdata, nbyte, hexits[cases % 2], (char *)out);
+}
+
+int hex_decode(const void *pdata, size_t nbyte, void *out)
+{
+    assert(!nbyte || pdata);
+    assert(!nbyte || out);
+    if (nbyte % 2)
+    {
+        return ~0;
+    }
+    return decode_pick()((const unsigned char *)pdata, nbyte, (unsigned char *)out);
+}
+
+int hex_xdigits(const void *pdata, size_t nbyte, void *out)
+{
+    assert(!nbyte || pdata);
+    assert(!nbyte || out);
+    return nibble_pick()((const unsigned char *)pdata, nbyte, (unsigned char *)out);
+}
+
+void *digest(const void *pdata, size_t nbyte, unsigned int cases, void *out)
+{
     assert(!nbyte || pdata);
 
-    const char *hexit = hexits[cases % 2];
-    const unsigned char *p = (const unsigned char *)pdata;
     if (out || ((void)(out = malloc((nbyte << 1) + 1)), out))
     {
+        *hex_encode(pdata, nbyte, cases, out) = 0;
+    }
+
+    return out;
+}
+
+void *digests(const void *pdata, size_t nbyte, size_t count, unsigned int cases, void *out)
+{
+    assert(!nbyte || !count || pdata);
+
+    size_t stride = (nbyte << 1) + 1;
+    if (out || ((void)(out = malloc(stride * count + !count)), out))
+    {
+        /* pick the kernel once for the whole batch */
+        encode_f func = encode_pick();
+        const char *hexit = hexits[cases % 2];
+        const unsigned char *p = (const unsigned char *)pdata;
         char *o = (char *)out;
-        pdata = (const void *)(p + nbyte);
-        while (p != pdata)
+        for (size_t i = 0; i != count; ++i, p += nbyte, o += stride)
         {
-            *o++ = hexit[*p >> 0x4];
-            *o++ = hexit[*p & 0x0F];
-            ++p;
+            *func(p, nbyte, hexit, o) = 0;
         }
-        *o = 0;
     }
 
     return out;
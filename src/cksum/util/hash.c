@@ -7,6 +7,7 @@
 #include "cksum/util/hash.h"
 
 #include "../hash.h"
+#include "uring.h"
 
 #include <assert.h>
 #include <stdarg.h>
@@ -103,6 +104,18 @@ int hash_filehandle(const hash_s *ctx, FILE *in, void *out, size_t *siz)
     return SUCCESS;
 }
 
+typedef struct hash_uring_s
+{
+    const hash_s *ctx;
+    hash_u hash[1];
+} hash_uring_s;
+
+static int hash_uring(void *ctx, const void *pdata, size_t nbyte)
+{
+    hash_uring_s *uring = (hash_uring_s *)ctx;
+    return uring->ctx->proc(uring->hash, pdata, nbyte);
+}
+
 int hash_file(const hash_s *ctx, const char *fname, void *out, size_t *siz)
 {
     assert(ctx);
@@ -116,13 +129,27 @@ int hash_file(const hash_s *ctx, const char *fname, void *out, size_t *siz)
         return OVERFLOW;
     }
 
+    hash_uring_s uring[1];
+    uring->ctx = ctx;
+    ctx->init(uring->hash);
+    int ret = uring_file(fname, hash_uring, uring);
+    if (ret != WARNING)
+    {
+        if (ret == SUCCESS)
+        {
+            *siz = ctx->done(uring->hash, out) ? ctx->outsiz : 0;
+        }
+        return ret;
+    }
+
+    /* the ring may have consumed part of the file, hash_filehandle starts over with a state of its own */
     FILE *in = fopen(fname, "rb");
     if (in == 0)
     {
         return NOTFOUND;
     }
 
-    int ret = hash_filehandle(ctx, in, out, siz);
+    ret = hash_filehandle(ctx, in, out, siz);
 
     if (fclose(in))
     {
@@ -131,3 +158,8 @@ int hash_file(const hash_s *ctx, const char *fname, void *out, size_t *siz)
 
     return ret;
 }
+
+void hash_file_release(void)
+{
+    uring_release();
+}
@@ -0,0 +1,124 @@
+/*!
+ @file hkdf.c
+ @brief RFC 5869 compliant HKDF implementation
+ @details https://www.ietf.org/rfc/rfc5869.txt
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#include "cksum/util/hkdf.h"
+
+#include "../hash.h"
+
+#include <assert.h>
+
+int hkdf_extract(const hash_s *hash, const void *psalt, size_t nsalt, const void *pikm, size_t nikm, void *out, size_t *siz)
+{
+    assert(out);
+    assert(siz);
+    assert(hash);
+    assert(!nsalt || psalt);
+    assert(!nikm || pikm);
+
+    if (*siz < hash->outsiz)
+    {
+        *siz = hash->outsiz;
+        return OVERFLOW;
+    }
+
+    /* a key of zeros is padded to the same block as an empty key */
+    hmac_s ctx[1];
+    if (hmac_init(ctx, hash, psalt, nsalt) != SUCCESS)
+    {
+        return FAILURE;
+    }
+    if (hmac_proc(ctx, pikm, nikm) != SUCCESS)
+    {
+        return FAILURE;
+    }
+    *siz = hmac_done(ctx, out) ? hash->outsiz : 0;
+
+    return SUCCESS;
+}
+
+int hkdf_init(hmac_s *ctx, const hash_s *hash, const void *pprk, size_t nprk)
+{
+    assert(ctx);
+    assert(hash);
+    assert(!nprk || pprk);
+
+    return hmac_init(ctx, hash, pprk, nprk);
+}
+
+int hkdf_expand(const hmac_s *ctx, const void *pinfo, size_t ninfo, void *out, size_t siz)
+{
+    assert(ctx);
+    assert(!siz || out);
+    assert(!ninfo || pinfo);
+
+    unsigned int outsiz = ctx->outsiz;
+    if (siz > 0xFF * (size_t)outsiz)
+    {
+        return OVERFLOW;
+    }
+
+    hmac_s hmac[1];
+    unsigned char *o = (unsigned char *)out;
+    const unsigned char *t = 0;
+    for (unsigned char i = 1; siz; ++i)
+    {
+        /* T(i) = HMAC(PRK, T(i - 1) | info | i), keyed by a copy of the prepared state */
+        memcpy(hmac, ctx, sizeof(hmac_s));
+        if (t && hmac_proc(hmac, t, outsiz) != SUCCESS)
+        {
+            return FAILURE;
+        }
+        if (hmac_proc(hmac, pinfo, ninfo) != SUCCESS)
+        {
+            return FAILURE;
+        }
+        if (hmac_proc(hmac, &i, 1) != SUCCESS)
+        {
+            return FAILURE;
+        }
+        if (siz < outsiz)
+        {
+            /* only the last block can be partial */
+            if (hmac_done(hmac, hmac->buf) == 0)
+            {
+                return FAILURE;
+            }
+            memcpy(o, hmac->buf, siz);
+            break;
+        }
+        if (hmac_done(hmac, o) == 0)
+        {
+            return FAILURE;
+        }
+        t = o;
+        o += outsiz;
+        siz -= outsiz;
+    }
+
+    return SUCCESS;
+}
+
+int hkdf(const hash_s *hash, const void *psalt, size_t nsalt, const void *pikm, size_t nikm,
+         const void *pinfo, size_t ninfo, void *out, size_t siz)
+{
+    assert(hash);
+
+    unsigned char prk[HMAC_BUFSIZ];
+    size_t nprk = sizeof(prk);
+    if (hkdf_extract(hash, psalt, nsalt, pikm, nikm, prk, &nprk) != SUCCESS)
+    {
+        return FAILURE;
+    }
+
+    hmac_s ctx[1];
+    if (hkdf_init(ctx, hash, prk, nprk) != SUCCESS)
+    {
+        return FAILURE;
+    }
+
+    return hkdf_expand(ctx, pinfo, ninfo, out, siz);
+}
@@ -7,6 +7,7 @@
 #include "cksum/util/hmac.h"
 
 #include "../hash.h"
+#include "uring.h"
 
 #include <assert.h>
 #include <stdarg.h>
@@ -115,6 +116,11 @@ int hmac_filehandle(const hash_s *hash, const void *pkey, size_t nkey, FILE *in,
     return SUCCESS;
 }
 
+static int hmac_uring(void *ctx, const void *pdata, size_t nbyte)
+{
+    return hmac_proc((hmac_s *)ctx, pdata, nbyte);
+}
+
 int hmac_file(const hash_s *hash, const void *pkey, size_t nkey, const char *fname, void *out, size_t *siz)
 {
     assert(out);
@@ -129,13 +135,29 @@ int hmac_file(const hash_s *hash, const void *pkey, size_t nkey, const char *fna
         return OVERFLOW;
     }
 
+    hmac_s hmac[1];
+    if (hmac_init(hmac, hash, pkey, nkey) != SUCCESS)
+    {
+        return FAILURE;
+    }
+    int ret = uring_file(fname, hmac_uring, hmac);
+    if (ret != WARNING)
+    {
+        if (ret == SUCCESS)
+        {
+            *siz = hmac_done(hmac, out) ? hash->outsiz : 0;
+        }
+        return ret;
+    }
+
+    /* the ring may have consumed part of the file, hmac_filehandle starts over with a state of its own */
     FILE *in = fopen(fname, "rb");
     if (in == 0)
     {
         return NOTFOUND;
     }
 
-    int ret = hmac_filehandle(hash, pkey, nkey, in, out, siz);
+    ret = hmac_filehandle(hash, pkey, nkey, in, out, siz);
 
     if (fclose(in))
     {
@@ -0,0 +1,344 @@
+/*!
+ @file state.c
+ @brief hash state serialization
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#include "cksum/util/state.h"
+
+#include "../hash.h"
+
+#include <assert.h>
+
+/*
+ layout of a blob, every integer is stored as little-endian:
+   0  4  magic "CKHS"
+   4  1  HASH_STATE_VERSION
+   5  1  identifier of the hash, its index in state_hash plus one
+   6  2  size of the payload
+   8  ~  payload, the fields of the hash state in declaration order
+*/
+#undef STATE_HEAD
+#define STATE_HEAD 8
+
+static const hash_s *const state_hash[] = {
+    &hash_md5,
+    &hash_sha1,
+    &hash_sha224,
+    &hash_sha256,
+    &hash_sha384,
+    &hash_sha512,
+    &hash_sha512_224,
+    &hash_sha512_256,
+    &hash_sha3_224,
+    &hash_sha3_256,
+    &hash_sha3_384,
+    &hash_sha3_512,
+    &hash_shake128,
+    &hash_shake256,
+    &hash_keccak224,
+    &hash_keccak256,
+    &hash_keccak384,
+    &hash_keccak512,
+    &hash_blake2s_128,
+    &hash_blake2s_160,
+    &hash_blake2s_224,
+    &hash_blake2s_256,
+    &hash_blake2b_160,
+    &hash_blake2b_256,
+    &hash_blake2b_384,
+    &hash_blake2b_512,
+};
+
+static unsigned int state_id(const hash_s *ctx)
+{
+    for (unsigned int i = 0; i != sizeof(state_hash) / sizeof(*state_hash); ++i)
+    {
+        if (state_hash[i] == ctx)
+        {
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static unsigned char *state_put(unsigned char *p, uint64_t x, unsigned int n)
+{
+    for (unsigned int i = 0; i != n; ++i)
+    {
+        p[i] = (unsigned char)(x >> (i << 3));
+    }
+    return p + n;
+}
+
+static uint64_t state_get(const unsigned char **p, unsigned int n)
+{
+    uint64_t x = 0;
+    for (unsigned int i = 0; i != n; ++i)
+    {
+        x |= (uint64_t)(*p)[i] << (i << 3);
+    }
+    *p += n;
+    return x;
+}
+
+/* md5, sha1 and sha2 */
+#undef STATE_MD
+#define STATE_MD(hash, word, size, save, load)                                           \
+    static size_t size(void)                                                             \
+    {                                                                                    \
+        hash *ctx = 0;                                                                   \
+        return 8 + sizeof(ctx->__state) + sizeof(ctx->__buf) + 4;                        \
+    }                                                                                    \
+    static void save(const hash *ctx, unsigned char *p)                                  \
+    {                                                                                    \
+        p = state_put(p, ctx->__length, 8);                                              \
+        for (unsigned int i = 0; i != sizeof(ctx->__state) / sizeof(*ctx->__state); ++i) \
+        {                                                                                \
+            p = state_put(p, ctx->__state[i], sizeof(*ctx->__state));                    \
+        }                                                                                \
+        memcpy(p, ctx->__buf, sizeof(ctx->__buf));                                       \
+        state_put(p + sizeof(ctx->__buf), ctx->__cursiz, 4);                             \
+    }                                                                                    \
+    static int load(hash *ctx, const unsigned char *p)                                   \
+    {                                                                                    \
+        ctx->__length = state_get(&p, 8);                                                \
+        for (unsigned int i = 0; i != sizeof(ctx->__state) / sizeof(*ctx->__state); ++i) \
+        {                                                                                \
+            ctx->__state[i] = (word)state_get(&p, sizeof(*ctx->__state));                \
+        }                                                                                \
+        memcpy(ctx->__buf, p, sizeof(ctx->__buf));                                       \
+        p += sizeof(ctx->__buf);                                                         \
+        ctx->__cursiz = (uint32_t)state_get(&p, 4);                                      \
+        return ctx->__cursiz < sizeof(ctx->__buf) ? SUCCESS : INVALID;                   \
+    }
+STATE_MD(md5_s, uint32_t, state_size_md5, state_save_md5, state_load_md5)
+STATE_MD(sha1_s, uint32_t, state_size_sha1, state_save_sha1, state_load_sha1)
+STATE_MD(sha256_s, uint32_t, state_size_sha256, state_save_sha256, state_load_sha256)
+STATE_MD(sha512_s, uint64_t, state_size_sha512, state_save_sha512, state_load_sha512)
+#undef STATE_MD
+
+/* blake2s and blake2b */
+#undef STATE_BLAKE2
+#define STATE_BLAKE2(hash, word, size, save, load)                                       \
+    static size_t size(void)                                                             \
+    {                                                                                    \
+        hash *ctx = 0;                                                                   \
+        return sizeof(ctx->__t) + sizeof(ctx->__f) + 4 + 4 +                             \
+               sizeof(ctx->__state) + sizeof(ctx->__buf) + 1;                            \
+    }                                                                                    \
+    static void save(const hash *ctx, unsigned char *p)                                  \
+    {                                                                                    \
+        p = state_put(p, ctx->__t[0], sizeof(*ctx->__t));                                \
+        p = state_put(p, ctx->__t[1], sizeof(*ctx->__t));                                \
+        p = state_put(p, ctx->__f[0], sizeof(*ctx->__f));                                \
+        p = state_put(p, ctx->__f[1], sizeof(*ctx->__f));                                \
+        p = state_put(p, ctx->__cursiz, 4);                                              \
+        p = state_put(p, ctx->outsiz, 4);                                                \
+        for (unsigned int i = 0; i != sizeof(ctx->__state) / sizeof(*ctx->__state); ++i) \
+        {                                                                                \
+            p = state_put(p, ctx->__state[i], sizeof(*ctx->__state));                    \
+        }                                                                                \
+        memcpy(p, ctx->__buf, sizeof(ctx->__buf));                                       \
+        p[sizeof(ctx->__buf)] = ctx->__lastnode;                                         \
+    }                                                                                    \
+    static int load(hash *ctx, const unsigned char *p)                                   \
+    {                                                                                    \
+        uint32_t outsiz = ctx->outsiz;                                                   \
+        ctx->__t[0] = (word)state_get(&p, sizeof(*ctx->__t));                            \
+        ctx->__t[1] = (word)state_get(&p, sizeof(*ctx->__t));                            \
+        ctx->__f[0] = (word)state_get(&p, sizeof(*ctx->__f));                            \
+        ctx->__f[1] = (word)state_get(&p, sizeof(*ctx->__f));                            \
+        ctx->__cursiz = (uint32_t)state_get(&p, 4);                                      \
+        ctx->outsiz = (uint32_t)state_get(&p, 4);                                        \
+        for (unsigned int i = 0; i != sizeof(ctx->__state) / sizeof(*ctx->__state); ++i) \
+        {                                                                                \
+            ctx->__state[i] = (word)state_get(&p, sizeof(*ctx->__state));                \
+        }                                                                                \
+        memcpy(ctx->__buf, p, sizeof(ctx->__buf));                                       \
+        ctx->__lastnode = p[sizeof(ctx->__buf)];                                         \
+        if (ctx->__cursiz > sizeof(ctx->__buf) || ctx->outsiz != outsiz)                 \
+        {                                                                                \
+            return INVALID;                                                              \
+        }                                                                                \
+        return SUCCESS;                                                                  \
+    }
+STATE_BLAKE2(blake2s_s, uint32_t, state_size_blake2s, state_save_blake2s, state_load_blake2s)
+STATE_BLAKE2(blake2b_s, uint64_t, state_size_blake2b, state_save_blake2b, state_load_blake2b)
+#undef STATE_BLAKE2
+
+/* sha3, shake and keccak */
+static size_t state_size_sha3(void)
+{
+    sha3_s *ctx = 0;
+    return sizeof(ctx->__s) + 8 + 2 * 4;
+}
+
+static void state_save_sha3(const sha3_s *ctx, unsigned char *p)
+{
+    for (unsigned int i = 0; i != sizeof(ctx->__s) / sizeof(*ctx->__s); ++i)
+    {
+        p = state_put(p, ctx->__s[i], 8);
+    }
+    p = state_put(p, ctx->__saved, 8);
+    p = state_put(p, ctx->__byte_index, 2);
+    p = state_put(p, ctx->__word_index, 2);
+    p = state_put(p, ctx->__capacity_words, 2);
+    state_put(p, ctx->__xof_flag, 2);
+}
+
+static int state_load_sha3(sha3_s *ctx, const unsigned char *p)
+{
+    unsigned short capacity_words = ctx->__capacity_words;
+    for (unsigned int i = 0; i != sizeof(ctx->__s) / sizeof(*ctx->__s); ++i)
+    {
+        ctx->__s[i] = state_get(&p, 8);
+    }
+    ctx->__saved = state_get(&p, 8);
+    ctx->__byte_index = (unsigned short)state_get(&p, 2);
+    ctx->__word_index = (unsigned short)state_get(&p, 2);
+    ctx->__capacity_words = (unsigned short)state_get(&p, 2);
+    ctx->__xof_flag = (unsigned short)state_get(&p, 2);
+    if (ctx->__capacity_words != capacity_words ||
+        ctx->__word_index >= sizeof(ctx->__s) / sizeof(*ctx->__s) - capacity_words ||
+        (ctx->__xof_flag == 0 && ctx->__byte_index > 7))
+    {
+        return INVALID;
+    }
+    return SUCCESS;
+}
+
+static size_t state_size(unsigned int id)
+{
+    if (id < 2)
+    {
+        return id ? state_size_sha1() : state_size_md5();
+    }
+    if (id < 4)
+    {
+        return state_size_sha256();
+    }
+    if (id < 8)
+    {
+        return state_size_sha512();
+    }
+    if (id < 18)
+    {
+        return state_size_sha3();
+    }
+    if (id < 22)
+    {
+        return state_size_blake2s();
+    }
+    return state_size_blake2b();
+}
+
+int hash_state_export(const hash_s *ctx, const hash_u *hash, void *out, size_t *siz)
+{
+    assert(ctx);
+    assert(siz);
+    assert(hash);
+    assert(!*siz || out);
+
+    unsigned int id = state_id(ctx);
+    if (id-- == 0)
+    {
+        return NOTFOUND;
+    }
+    size_t n = state_size(id);
+    if (*siz < STATE_HEAD + n)
+    {
+        *siz = STATE_HEAD + n;
+        return OVERFLOW;
+    }
+    *siz = STATE_HEAD + n;
+
+    unsigned char *p = (unsigned char *)out;
+    memcpy(p, "CKHS", 4);
+    p[4] = HASH_STATE_VERSION;
+    p[5] = (unsigned char)(id + 1);
+    p = state_put(p + 6, n, 2);
+    if (id < 2)
+    {
+        id ? state_save_sha1(hash->sha1, p) : state_save_md5(hash->md5, p);
+    }
+    else if (id < 4)
+    {
+        state_save_sha256(hash->sha256, p);
+    }
+    else if (id < 8)
+    {
+        state_save_sha512(hash->sha512, p);
+    }
+    else if (id < 18)
+    {
+        state_save_sha3(hash->sha3, p);
+    }
+    else if (id < 22)
+    {
+        state_save_blake2s(hash->blake2s, p);
+    }
+    else
+    {
+        state_save_blake2b(hash->blake2b, p);
+    }
+
+    return SUCCESS;
+}
+
+int hash_state_import(const hash_s *ctx, hash_u *hash, const void *pdata, size_t nbyte)
+{
+    assert(ctx);
+    assert(hash);
+    assert(!nbyte || pdata);
+
+    unsigned int id = state_id(ctx);
+    if (id-- == 0)
+    {
+        return NOTFOUND;
+    }
+    size_t n = state_size(id);
+    const unsigned char *p = (const unsigned char *)pdata;
+    if (nbyte != STATE_HEAD + n || memcmp(p, "CKHS", 4) ||
+        p[4] != HASH_STATE_VERSION || p[5] != id + 1 ||
+        (size_t)(p[6] | p[7] << 8) != n)
+    {
+        return INVALID;
+    }
+    p += STATE_HEAD;
+
+    /* the parameters that are fixed by the hash come from a fresh state */
+    int ret;
+    hash_u state[1];
+    ctx->init(state);
+    if (id < 2)
+    {
+        ret = id ? state_load_sha1(state->sha1, p) : state_load_md5(state->md5, p);
+    }
+    else if (id < 4)
+    {
+        ret = state_load_sha256(state->sha256, p);
+    }
+    else if (id < 8)
+    {
+        ret = state_load_sha512(state->sha512, p);
+    }
+    else if (id < 18)
+    {
+        ret = state_load_sha3(state->sha3, p);
+    }
+    else if (id < 22)
+    {
+        ret = state_load_blake2s(state->blake2s, p);
+    }
+    else
+    {
+        ret = state_load_blake2b(state->blake2b, p);
+    }
+    if (ret == SUCCESS)
+    {
+        memcpy(hash, state, sizeof(hash_u));
+    }
+
+    return ret;
+}
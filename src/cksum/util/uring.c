@@ -0,0 +1,345 @@
+/*!
+ @file uring.c
+ @brief private io_uring read pipeline for hash library utils
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#if defined(HAS_IO_URING_H)
+#undef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif /* HAS_IO_URING_H */
+
+#include "uring.h"
+
+#include "../hash.h"
+
+#if defined(HAS_IO_URING_H)
+
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+/* one ring per thread, reused across files so the registered buffers stay pinned */
+typedef struct uring_s
+{
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    unsigned char *buf;
+    void *sq; /* the mappings of the ring, released by uring_free */
+    void *cq;
+    size_t sqsiz;
+    size_t cqsiz;
+    size_t sesiz;
+    struct iovec iov[URING_DEPTH];
+    int res[URING_DEPTH];
+    unsigned char done[URING_DEPTH];
+    unsigned int submit;
+    int fixed; /* buffers are registered */
+    int state; /* 0 untried, 1 ready, -1 unsupported */
+    int fd;
+} uring_s;
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+static _Thread_local uring_s uring[1];
+
+static int uring_setup(uring_s *ctx)
+{
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    int fd = (int)syscall(__NR_io_uring_setup, URING_DEPTH, &p);
+    if (fd < 0)
+    {
+        return WARNING;
+    }
+
+    size_t sqsiz = p.sq_off.array + p.sq_entries * sizeof(unsigned int);
+    size_t cqsiz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    int single = 0;
+#if defined(IORING_FEAT_SINGLE_MMAP)
+    if (p.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        sqsiz = sqsiz < cqsiz ? cqsiz : sqsiz;
+        single = 1;
+    }
+#endif /* IORING_FEAT_SINGLE_MMAP */
+
+    size_t sesiz = p.sq_entries * sizeof(struct io_uring_sqe);
+    unsigned char *sq = (unsigned char *)mmap(0, sqsiz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    unsigned char *cq = single ? sq : (unsigned char *)mmap(0, cqsiz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+    void *se = mmap(0, sesiz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    void *buf = mmap(0, URING_DEPTH * URING_BUFSIZ, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (sq == MAP_FAILED || cq == MAP_FAILED || se == MAP_FAILED || buf == MAP_FAILED)
+    {
+        if (sq != MAP_FAILED)
+        {
+            munmap(sq, sqsiz);
+        }
+        if (cq != MAP_FAILED && cq != sq)
+        {
+            munmap(cq, cqsiz);
+        }
+        if (se != MAP_FAILED)
+        {
+            munmap(se, sesiz);
+        }
+        if (buf != MAP_FAILED)
+        {
+            munmap(buf, URING_DEPTH * URING_BUFSIZ);
+        }
+        close(fd);
+        return WARNING;
+    }
+    ctx->sqes = (struct io_uring_sqe *)se;
+    ctx->buf = (unsigned char *)buf;
+    ctx->sq = sq;
+    ctx->cq = cq;
+    ctx->sqsiz = sqsiz;
+    ctx->cqsiz = cqsiz;
+    ctx->sesiz = sesiz;
+
+    ctx->sq_head = (unsigned int *)(sq + p.sq_off.head);
+    ctx->sq_tail = (unsigned int *)(sq + p.sq_off.tail);
+    ctx->sq_mask = (unsigned int *)(sq + p.sq_off.ring_mask);
+    ctx->sq_array = (unsigned int *)(sq + p.sq_off.array);
+    ctx->cq_head = (unsigned int *)(cq + p.cq_off.head);
+    ctx->cq_tail = (unsigned int *)(cq + p.cq_off.tail);
+    ctx->cq_mask = (unsigned int *)(cq + p.cq_off.ring_mask);
+    ctx->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+
+    for (unsigned int i = 0; i != URING_DEPTH; ++i)
+    {
+        ctx->iov[i].iov_base = ctx->buf + URING_BUFSIZ * i;
+        ctx->iov[i].iov_len = URING_BUFSIZ;
+    }
+    /* pinning may fail under a small RLIMIT_MEMLOCK, plain vectored reads still work */
+    ctx->fixed = syscall(__NR_io_uring_register, fd, IORING_REGISTER_BUFFERS, ctx->iov, URING_DEPTH) == 0;
+    ctx->submit = 0;
+    ctx->fd = fd;
+
+    return SUCCESS;
+}
+
+/* closing the ring cancels the reads still in flight before the buffers are unmapped */
+static void uring_free(uring_s *ctx)
+{
+    close(ctx->fd);
+    if (ctx->cq != ctx->sq)
+    {
+        munmap(ctx->cq, ctx->cqsiz);
+    }
+    munmap(ctx->sq, ctx->sqsiz);
+    munmap(ctx->sqes, ctx->sesiz);
+    munmap(ctx->buf, URING_DEPTH * URING_BUFSIZ);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+static void uring_read(uring_s *ctx, int fd, unsigned int idx, uint64_t off)
+{
+    unsigned int tail = *ctx->sq_tail;
+    unsigned int i = tail & *ctx->sq_mask;
+    struct io_uring_sqe *sqe = ctx->sqes + i;
+
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->off = off;
+    sqe->user_data = idx;
+    if (ctx->fixed)
+    {
+        sqe->opcode = IORING_OP_READ_FIXED;
+        sqe->addr = (uint64_t)(uintptr_t)ctx->iov[idx].iov_base;
+        sqe->len = URING_BUFSIZ;
+        sqe->buf_index = (uint16_t)idx;
+    }
+    else
+    {
+        sqe->opcode = IORING_OP_READV;
+        sqe->addr = (uint64_t)(uintptr_t)(ctx->iov + idx);
+        sqe->len = 1;
+    }
+    ctx->sq_array[i] = i;
+    ctx->done[idx] = 0;
+
+    __atomic_store_n(ctx->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    ++ctx->submit;
+}
+
+static int uring_wait(uring_s *ctx, unsigned int idx)
+{
+    while (ctx->done[idx] == 0)
+    {
+        unsigned int head = *ctx->cq_head;
+        unsigned int tail = __atomic_load_n(ctx->cq_tail, __ATOMIC_ACQUIRE);
+        if (head == tail)
+        {
+            /* submit the pending reads and wait for completions in the same system call */
+            long ret = syscall(__NR_io_uring_enter, ctx->fd, ctx->submit, 1, IORING_ENTER_GETEVENTS, 0, 0);
+            if (ret < 0)
+            {
+                if (errno == EINTR || errno == EAGAIN)
+                {
+                    continue;
+                }
+                return FAILURE;
+            }
+            ctx->submit -= (unsigned int)ret;
+            continue;
+        }
+        for (; head != tail; ++head)
+        {
+            struct io_uring_cqe *cqe = ctx->cqes + (head & *ctx->cq_mask);
+            unsigned int i = (unsigned int)cqe->user_data;
+            ctx->res[i] = cqe->res;
+            ctx->done[i] = 1;
+        }
+        __atomic_store_n(ctx->cq_head, head, __ATOMIC_RELEASE);
+    }
+    return SUCCESS;
+}
+
+int uring_file(const char *fname, int (*proc)(void *, const void *, size_t), void *ctx)
+{
+    if (uring->state == 0)
+    {
+        uring->state = uring_setup(uring) == SUCCESS ? 1 : -1;
+    }
+    if (uring->state < 0)
+    {
+        return WARNING;
+    }
+
+    int fd = open(fname, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return NOTFOUND;
+    }
+    struct stat st;
+    if (fstat(fd, &st) || !S_ISREG(st.st_mode))
+    {
+        /* positional reads need a regular file */
+        close(fd);
+        return WARNING;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    int ret = SUCCESS;
+    int eof = 0;
+    uint64_t next = 0;
+    uint64_t off[URING_DEPTH];
+    unsigned int stale = 0;
+    unsigned int inflight = 0;
+
+    /* keep every buffer busy, block N is processed while blocks N+1.. are read */
+    for (unsigned int i = 0; i != URING_DEPTH; ++i, ++inflight)
+    {
+        off[i] = next;
+        uring_read(uring, fd, i, next);
+        next += URING_BUFSIZ;
+    }
+    for (unsigned int seq = 0; inflight; seq = (seq + 1) % URING_DEPTH)
+    {
+        if (uring_wait(uring, seq) != SUCCESS)
+        {
+            /* the ring is in an unknown state, stop using it and let stdio read the file */
+            uring_free(uring);
+            uring->state = -1;
+            ret = WARNING;
+            break;
+        }
+        --inflight;
+
+        int res = uring->res[seq];
+        if (eof || ret != SUCCESS)
+        {
+            continue;
+        }
+        if (stale)
+        {
+            /* issued past an earlier short read, the data is discarded */
+            --stale;
+        }
+        else if (res == -EINTR || res == -EAGAIN)
+        {
+            uring_read(uring, fd, seq, off[seq]);
+            ++inflight;
+            seq = (seq + URING_DEPTH - 1) % URING_DEPTH;
+            continue;
+        }
+        else if (res < 0)
+        {
+            ret = FAILURE;
+            continue;
+        }
+        else if (res == 0)
+        {
+            eof = 1;
+            continue;
+        }
+        else
+        {
+            if (proc(ctx, uring->iov[seq].iov_base, (size_t)res) != SUCCESS)
+            {
+                ret = FAILURE;
+                continue;
+            }
+            if (res != URING_BUFSIZ)
+            {
+                /* a short read shifts every later block, reissue them from here */
+                stale = inflight;
+                next = off[seq] + (uint64_t)res;
+            }
+        }
+        off[seq] = next;
+        uring_read(uring, fd, seq, next);
+        next += URING_BUFSIZ;
+        ++inflight;
+    }
+
+    close(fd);
+    return ret;
+}
+
+void uring_release(void)
+{
+    if (uring->state > 0)
+    {
+        uring_free(uring);
+    }
+}
+
+#else /* !HAS_IO_URING_H */
+
+int uring_file(const char *fname, int (*proc)(void *, const void *, size_t), void *ctx)
+{
+    (void)fname;
+    (void)proc;
+    (void)ctx;
+    return WARNING;
+}
+
+void uring_release(void)
+{
+}
+
+#endif /* HAS_IO_URING_H */
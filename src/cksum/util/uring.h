@@ -0,0 +1,38 @@
+/*!
+ @file uring.h
+ @brief private io_uring read pipeline for hash library utils
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#ifndef __CKSUM_UTIL_URING_H__
+#define __CKSUM_UTIL_URING_H__
+
+#include <stddef.h>
+
+#undef URING_DEPTH
+#undef URING_BUFSIZ
+/* number of registered buffers kept in flight */
+#define URING_DEPTH 4
+/* size of every registered buffer */
+#define URING_BUFSIZ 0x10000
+
+/*!
+ @brief Read a whole file through io_uring and feed it to a process function in order.
+ @param[in] fname name of file to read.
+ @param[in] proc process function that consumes the file data.
+ @param[in,out] ctx points to the state passed to the process function.
+ @return the execution state of the function.
+  @retval 0 success
+  @retval -1 io_uring is unsupported or the ring failed, fall back to stdio with a new state,
+   some of the file may have been consumed already
+  @retval -2 failure while reading or processing
+  @retval -5 file not found
+*/
+int uring_file(const char *fname, int (*proc)(void *, const void *, size_t), void *ctx);
+
+/*!
+ @brief Release the ring of the calling thread, the next read sets up a new one.
+*/
+void uring_release(void);
+
+#endif /* __CKSUM_UTIL_URING_H__ */
@@ -8,6 +8,8 @@
 
 #include "clipboard.h"
 
+#include "cipher/a/cols.h"
+
 #include <assert.h>
 
 // clang-format off
@@ -109,6 +111,9 @@ int app_exec(const cipher_s *info, cstr_t word)
 #define STATUS_ZERO 0
 #define STATUS_INIT (1 << 0)
 #define STATUS_DONE (1 << 1)
+#define STATUS_COLS (1 << 2)
+#define STATUS_INFO (1 << 3)
+#define STATUS_RDWR (1 << 4)
 #define STATUS_MODP (1 << 8)
 #define STATUS_MODK (1 << 9)
 
@@ -120,20 +125,39 @@ int app_exec(const cipher_s *info, cstr_t word)
 #pragma pack(push, 4)
 static struct
 {
-    sqlite3 *db;
+    c_sqlite_s sql[1];
     cstr_t fname;
     c_word_s word[1];
     c_info_s info[1];
+    c_cols_s cols[1];
     int status;
 } local[1] = {
     {
-        .db = 0,
         .fname = 0,
         .status = STATUS_ZERO,
     },
 };
 #pragma pack(pop)
 
+/* open the store for writing, the connection that only reads is closed */
+static int app_write_(void)
+{
+    if (STATUS_IS_SET(local->status, STATUS_RDWR))
+    {
+        return SQLITE_OK;
+    }
+    c_sqlite_close(local->sql);
+    int ok = c_sqlite_open(local->sql, local->fname, C_SQLITE_INTERACTIVE);
+    if (ok != SQLITE_OK)
+    {
+        fprintf(stderr, "%s\n", sqlite3_errmsg(c_sqlite_db(local->sql)));
+        exit(EXIT_FAILURE);
+    }
+    c_sqlite_init(local->sql);
+    STATUS_SET(local->status, STATUS_RDWR);
+    return ok;
+}
+
 int app_init(cstr_t fname)
 {
     assert(fname);
@@ -146,26 +170,43 @@ int app_init(cstr_t fname)
     sqlite3_initialize();
     STATUS_CLR(local->status, STATUS_DONE);
 
-    int ok = sqlite3_open(fname, &local->db);
-    if (ok != SQLITE_OK)
+    /* the store is only read until the first change, so lookups never wait for each other */
+    local->fname = fname;
+    int ok = c_sqlite_open(local->sql, fname, C_SQLITE_READ_ONLY_MMAP);
+    if (ok != SQLITE_OK || !c_sqlite_has_init(local->sql))
     {
-        fprintf(stderr, "%s\n", sqlite3_errmsg(local->db));
-        exit(EXIT_FAILURE);
+        ok = app_write_();
     }
-
-    local->fname = fname;
-    c_sqlite_init(local->db);
     STATUS_SET(local->status, STATUS_INIT);
 
     c_word_ctor(local->word);
     c_info_ctor(local->info);
 
-    c_sqlite_out_word(local->db, local->word);
-    c_sqlite_out_info(local->db, local->info);
+    /* the entries are loaded by the first command that needs all of them */
+    c_sqlite_out_word(local->sql, local->word);
 
     return ok;
 }
 
+static c_info_s *app_info_(void)
+{
+    if (STATUS_IS_CLR(local->status, STATUS_INFO))
+    {
+        c_sqlite_out_info(local->sql, local->info);
+        STATUS_SET(local->status, STATUS_INFO);
+    }
+    return local->info;
+}
+
+static size_t app_info_num_(void)
+{
+    if (STATUS_IS_SET(local->status, STATUS_INFO))
+    {
+        return c_info_num(local->info);
+    }
+    return c_sqlite_count_info(local->sql);
+}
+
 int app_exit(void)
 {
     if (STATUS_IS_CLR(local->status, STATUS_INIT))
@@ -173,57 +214,101 @@ int app_exit(void)
         return FAILURE;
     }
 
-    if (STATUS_IS_SET(local->status, STATUS_MODP))
+    int ok = SUCCESS;
+    if (STATUS_IS_SET(local->status, STATUS_MODP) || STATUS_IS_SET(local->status, STATUS_MODK))
     {
-        c_sqlite_delete_word(local->db);
-        c_sqlite_create_word(local->db);
-        c_sqlite_add_word(local->db, local->word);
-        STATUS_CLR(local->status, STATUS_MODP);
+        /* only the rows of the journaled changes are written */
+        app_write_();
+        int ret = c_sqlite_apply_changes(local->sql, local->word, local->info);
+        if (ret != SQLITE_OK)
+        {
+            /* the transaction is rolled back by now, so the code tells what failed */
+            fprintf(stderr, "%s\n", sqlite3_errstr(ret));
+            ok = FAILURE;
+        }
+        STATUS_CLR(local->status, STATUS_MODP | STATUS_MODK);
     }
-    if (STATUS_IS_SET(local->status, STATUS_MODK))
+
+    if (STATUS_IS_SET(local->status, STATUS_RDWR))
     {
-        c_sqlite_delete_info(local->db);
-        c_sqlite_create_info(local->db);
-        c_sqlite_add_info(local->db, local->info);
-        STATUS_CLR(local->status, STATUS_MODK);
+        c_sqlite_exit(local->sql);
     }
-
-    c_sqlite_exit(local->db);
-    sqlite3_close(local->db);
-    STATUS_CLR(local->status, STATUS_INIT);
+    c_sqlite_close(local->sql);
+    STATUS_CLR(local->status, STATUS_INIT | STATUS_RDWR);
 
     c_word_dtor(local->word);
     c_info_dtor(local->info);
+    STATUS_CLR(local->status, STATUS_INFO);
+    if (STATUS_IS_SET(local->status, STATUS_COLS))
+    {
+        c_cols_dtor(local->cols);
+        STATUS_CLR(local->status, STATUS_COLS);
+    }
     STATUS_SET(local->status, STATUS_DONE);
 
-    return sqlite3_shutdown();
+    int ret = sqlite3_shutdown();
+    return ok == SUCCESS ? ret : ok;
 }
 
 void app_search_word_str(cptr_t word)
 {
     printf(TITLE_WORD);
     cstr_t str = word ? (cstr_t)word : "";
-    c_word_forenum(i, local->word)
+    size_t num = c_word_num(local->word);
+    for (size_t i = c_word_search(local->word, str, 0); i != num; i = c_word_search(local->word, str, i + 1))
     {
-        str_s *it = c_word_at(local->word, i);
-        if (str_len(it) && strstr(str_val(it), str))
-        {
-            app_print_word(i, str_val(it));
-        }
+        app_print_word(i, str_val(c_word_at(local->word, i)));
     }
 }
 
+static int app_print_info_(void *arg, size_t idx, const cipher_s *it)
+{
+    (void)arg;
+    app_print_info(idx, it);
+    return 0;
+}
+
 void app_search_info_str(cptr_t info)
 {
     printf(TITLE_INFO);
     cstr_t str = info ? (cstr_t)info : "";
-    c_info_forenum(i, local->info)
+    if (STATUS_IS_CLR(local->status, STATUS_INFO))
+    {
+        /* the texts alone are searched by sqlite, as by c_info_search, no entry is loaded */
+        c_sqlite_match_info(local->sql, str, app_print_info_, 0);
+        return;
+    }
+    /* the entries were loaded by an earlier command and may hold changes sqlite has not seen,
+       they are searched through the trigram index, built by the first query and kept */
+    size_t num = c_info_num(local->info);
+    for (size_t i = c_info_search(local->info, str, 0); i != num; i = c_info_search(local->info, str, i + 1))
     {
-        cipher_s *it = c_info_at(local->info, i);
-        if (cipher_get_text(it) && strstr(cipher_get_text(it), str))
+        app_print_info(i, c_info_at(local->info, i));
+    }
+}
+
+#define FUZZY_TOP 0x20
+void app_search_info_fuzzy(cptr_t info)
+{
+    printf(TITLE_INFO);
+    cstr_t str = info ? (cstr_t)info : "";
+    /* the snapshot is taken by the first query and kept for the next ones */
+    if (STATUS_IS_CLR(local->status, STATUS_COLS))
+    {
+        c_cols_ctor(local->cols);
+        if (c_cols_build(local->cols, app_info_()))
         {
-            app_print_info(i, it);
+            app_log(2, TEXT_RED, s_failure, TEXT_TURQUOISE, "search");
+            return;
         }
+        STATUS_SET(local->status, STATUS_COLS);
+    }
+    c_cols_hit_s top[FUZZY_TOP];
+    size_t num = c_cols_fuzzy(local->cols, str, top, FUZZY_TOP);
+    for (size_t i = 0; i != num; ++i)
+    {
+        size_t idx = local->cols->pos[top[i].row];
+        app_print_info(idx, c_info_at(local->info, idx));
     }
 }
 
@@ -251,16 +336,33 @@ void app_search_info_idx(const c_info_s *info)
     {
         printf(TITLE_INFO);
     }
+    size_t num = app_info_num_();
     c_info_foreach(it, info)
     {
         unsigned long idx = strtoul(cipher_get_text(it), 0, 0);
-        if (idx < c_info_num(local->info))
+        if (idx < num)
         {
             app_print_info(idx, it);
         }
     }
 }
 
+/* an entry is written at once unless the entries are loaded */
+static int app_put_info_(cipher_s *ctx)
+{
+    if (STATUS_IS_SET(local->status, STATUS_INFO))
+    {
+        int ok = c_info_add(local->info, ctx);
+        if (ok == SUCCESS)
+        {
+            STATUS_SET(local->status, STATUS_MODK);
+        }
+        return ok;
+    }
+    app_write_();
+    return c_sqlite_put_info(local->sql, ctx) == SQLITE_OK ? SUCCESS : FAILURE;
+}
+
 int app_create_word(const c_word_s *word)
 {
     assert(word);
@@ -302,10 +404,9 @@ int app_create_info(const c_info_s *info)
             app_log3(local->fname, TEXT_RED, s_missing, "k");
             break;
         }
-        ok = c_info_add(local->info, it);
+        ok = app_put_info_(it);
         if (ok == SUCCESS)
         {
-            STATUS_SET(local->status, STATUS_MODK);
             app_exec_ctx(it);
         }
         else
@@ -342,10 +443,23 @@ int app_delete_info(const c_info_s *info)
     int ok = FAILURE;
     c_info_foreach(it, info)
     {
-        ok = c_info_del(local->info, it);
+        if (STATUS_IS_SET(local->status, STATUS_INFO))
+        {
+            ok = c_info_del(local->info, it);
+            if (ok == SUCCESS)
+            {
+                STATUS_SET(local->status, STATUS_MODK);
+            }
+        }
+        else
+        {
+            app_write_();
+            ok = cipher_get_text(it) && c_sqlite_remove_info(local->sql, cipher_get_text(it)) == SQLITE_OK
+                     ? SUCCESS
+                     : FAILURE;
+        }
         if (ok == SUCCESS)
         {
-            STATUS_SET(local->status, STATUS_MODK);
             app_log3(local->fname, TEXT_GREEN, s_success, cipher_get_text(it));
         }
         else
@@ -369,7 +483,7 @@ int app_delete_word_idx(const c_word_s *word)
         {
             STATUS_SET(local->status, STATUS_MODP);
             app_print_word(x, str_val(str));
-            str_dtor(str);
+            c_word_erase(local->word, x);
             ok = SUCCESS;
         }
     }
@@ -380,16 +494,18 @@ int app_delete_info_idx(const c_info_s *info)
 {
     assert(info);
     int ok = FAILURE;
+    /* the positions stay the same while the entries are erased in memory */
+    c_info_s *all = app_info_();
     c_info_foreach(it, info)
     {
         cipher_s *ctx = 0;
         unsigned long x = strtoul(cipher_get_text(it), 0, 0);
-        if (x < c_info_num(local->info) &&
-            ((void)(ctx = c_info_at(local->info, x)), cipher_get_text(ctx)))
+        if (x < c_info_num(all) &&
+            ((void)(ctx = c_info_at(all, x)), cipher_get_text(ctx)))
         {
             STATUS_SET(local->status, STATUS_MODK);
             app_print_info(x, ctx);
-            cipher_dtor(ctx);
+            c_info_erase(all, x);
             ok = SUCCESS;
         }
     }
@@ -414,6 +530,7 @@ int app_exec_ctx(const cipher_s *ctx)
 int app_exec_idx(size_t word, size_t info)
 {
     int ok = FAILURE;
+    c_info_s *one = 0;
 
     if (c_word_num(local->word) == 0)
     {
@@ -426,14 +543,25 @@ int app_exec_idx(size_t word, size_t info)
         goto exit;
     }
 
-    if (c_info_num(local->info) == 0)
+    /* only the entry at info is read unless the entries are loaded */
+    c_info_s *all = local->info;
+    if (STATUS_IS_CLR(local->status, STATUS_INFO))
     {
-        app_log3(local->fname, TEXT_RED, s_missing, "k");
-        goto exit;
+        one = c_info_new();
+        if (one == 0)
+        {
+            app_log3(local->fname, TEXT_RED, s_failure, "k");
+            goto exit;
+        }
+        c_sqlite_page_info(local->sql, info, 1, one);
+        all = one;
+        info = 0;
     }
-    else if (info >= c_info_num(local->info))
+
+    if (info >= c_info_num(all))
     {
-        app_log3(local->fname, TEXT_RED, s_failure, "k");
+        cstr_t s = app_info_num_() ? s_failure : s_missing;
+        app_log3(local->fname, TEXT_RED, s, "k");
         goto exit;
     }
 
@@ -443,16 +571,30 @@ int app_exec_idx(size_t word, size_t info)
         STATUS_SET(local->status, STATUS_MODP);
     }
 
-    ok = app_exec(c_info_at(local->info, info),
+    ok = app_exec(c_info_at(all, info),
                   str_val(c_word_ptr(local->word)));
 
 exit:
+    c_info_die(one);
     return ok;
 }
 
 #include "cipher/json.h"
 #include "cipher/stream.h"
 
+#define LOAD_CHUNK 0x10000
+/* arg points to the name of the file */
+static int app_load_chunk_(void *arg, size_t idx, size_t num, int ok)
+{
+    if (ok != SQLITE_OK)
+    {
+        char buf[1 << 6];
+        sprintf(buf, "%zu+%zu", idx, num);
+        app_log3(*(cstr_t *)arg, TEXT_RED, s_failure, buf);
+    }
+    return 0;
+}
+
 static int app_import_(c_info_s *info, cstr_t in)
 {
     int ok = FAILURE;
@@ -466,14 +608,17 @@ static int app_import_(c_info_s *info, cstr_t in)
         return ok;
     }
 
-    sqlite3 *db = 0;
-    ok = sqlite3_open(in, &db);
+    c_sqlite_s sql[1];
+    ok = c_sqlite_open(sql, in, C_SQLITE_READ_ONLY_MMAP);
     if (ok == SQLITE_OK)
     {
-        return c_sqlite_out_info(db, info);
+        ok = c_sqlite_out_info(sql, info);
+    }
+    else
+    {
+        fprintf(stderr, "%s\n", sqlite3_errmsg(c_sqlite_db(sql)));
     }
-    fprintf(stderr, "%s\n", sqlite3_errmsg(db));
-    sqlite3_close(db);
+    c_sqlite_close(sql);
 
     return ok;
 }
@@ -482,16 +627,14 @@ static int app_export_(c_info_s *info, cstr_t out)
 {
     if (strstr(out, ".db"))
     {
-        sqlite3 *db = 0;
-        int ok = sqlite3_open(out, &db);
+        c_sqlite_s sql[1];
+        int ok = c_sqlite_open(sql, out, C_SQLITE_BULK_IMPORT);
         if (ok == SQLITE_OK)
         {
-            c_sqlite_create_info(db);
-            c_sqlite_begin(db);
-            c_sqlite_add_info(db, info);
-            c_sqlite_commit(db);
+            c_sqlite_create_info(sql);
+            c_sqlite_load_info(sql, info, LOAD_CHUNK, app_load_chunk_, &out);
         }
-        sqlite3_close(db);
+        c_sqlite_close(sql);
         return ok;
     }
 
@@ -536,10 +679,20 @@ int app_import(cstr_t fname)
     int ok = app_import_(info, fname);
     if (c_info_num(info) && ok == SUCCESS)
     {
-        STATUS_SET(local->status, STATUS_MODK);
-        c_info_foreach(it, info)
+        if (STATUS_IS_SET(local->status, STATUS_INFO))
+        {
+            c_info_foreach(it, info)
+            {
+                if (cipher_get_text(it))
+                {
+                    app_put_info_(it);
+                }
+            }
+        }
+        else
         {
-            c_info_add(local->info, it);
+            app_write_();
+            c_sqlite_load_info(local->sql, info, LOAD_CHUNK, app_load_chunk_, &fname);
         }
         app_log3(local->fname, TEXT_GREEN, s_success, fname);
     }
@@ -551,8 +704,36 @@ int app_import(cstr_t fname)
     return ok;
 }
 
+#define BACKUP_PAGES 0x400
+
 int app_export(cstr_t fname)
 {
     assert(fname);
-    return app_export_(local->info, fname);
+    /* a new database is a snapshot of the store, the entries are never loaded */
+    if (strstr(fname, ".db") && stream_size(fname) <= 0)
+    {
+        /* a store opened for writes is in a transaction, a backup reads it through a connection of its own */
+        c_sqlite_s sql[1];
+        c_sqlite_s *src = local->sql;
+        int ok = SQLITE_OK;
+        if (STATUS_IS_SET(local->status, STATUS_RDWR))
+        {
+            src = sql;
+            ok = c_sqlite_open(sql, local->fname, C_SQLITE_READ_ONLY_MMAP);
+        }
+        if (ok == SQLITE_OK)
+        {
+            ok = c_sqlite_backup(src, fname, BACKUP_PAGES, 0, 0);
+        }
+        if (src == sql)
+        {
+            c_sqlite_close(sql);
+        }
+        if (ok != SQLITE_OK)
+        {
+            app_log3(local->fname, TEXT_RED, s_failure, fname);
+        }
+        return ok;
+    }
+    return app_export_(app_info_(), fname);
 }
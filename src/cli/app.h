@@ -24,6 +24,7 @@ int app_exit(void);
 
 void app_search_word_str(cptr_t word);
 void app_search_info_str(cptr_t info);
+void app_search_info_fuzzy(cptr_t info);
 void app_search_word_idx(const c_word_s *word);
 void app_search_info_idx(const c_info_s *info);
 
@@ -14,6 +14,7 @@
 #define OPTION_SEARCH (1 << 1)
 #define OPTION_CREATE (1 << 2)
 #define OPTION_DELETE (1 << 3)
+#define OPTION_FUZZY (1 << 4)
 
 #define OPTION_SET(stat, mask) ((stat) |= (mask))
 #define OPTION_CLR(stat, mask) ((stat) &= ~(mask))
@@ -48,6 +49,7 @@ static void main_help(void)
     static const char help[] = "option: --import > -d[i] > -c > -s[i] > -i\n\
   -i --index     using the index\n\
   -s --search    search something\n\
+  -z --fuzzy     search by fuzzy match, best first\n\
   -c --create    create something\n\
   -d --delete    delete something\n\
   -a --hash      hash algorithm\n\
@@ -149,7 +151,14 @@ static int main_app(void)
         }
         c_info_foreach(it, local->info)
         {
-            app_search_info_str(cipher_get_text(it));
+            if (OPTION_IS_SET(local->option, OPTION_FUZZY))
+            {
+                app_search_info_fuzzy(cipher_get_text(it));
+            }
+            else
+            {
+                app_search_info_str(cipher_get_text(it));
+            }
         }
     }
     else if (c_info_num(local->info) && OPTION_IS_SET(local->option, OPTION_INDEX))
@@ -197,13 +206,14 @@ int main(int argc, char *argv[])
 {
     int ok = SUCCESS;
 
-    const char *shortopts = "Hiscda:k:h:m:t:l:p:f:";
+    const char *shortopts = "Hiscdza:k:h:m:t:l:p:f:";
     const struct option longopts[] = {
         {"help", no_argument, 0, 'H'},
         {"index", no_argument, 0, 'i'},
         {"search", no_argument, 0, 's'},
         {"create", no_argument, 0, 'c'},
         {"delete", no_argument, 0, 'd'},
+        {"fuzzy", no_argument, 0, 'z'},
         {"hash", required_argument, 0, 'a'},
         {"text", required_argument, 0, 'k'},
         {"hint", required_argument, 0, 'h'},
@@ -259,6 +269,11 @@ int main(int argc, char *argv[])
             OPTION_SET(local->option, OPTION_DELETE);
         }
         break;
+        case 'z':
+        {
+            OPTION_SET(local->option, OPTION_FUZZY);
+        }
+        break;
         case 'k':
         {
             if (cipher_get_hash(local->ctx) == 0)
@@ -278,6 +293,12 @@ int main(int argc, char *argv[])
         break;
         case 'a':
         {
+            /* an unknown algorithm must not fall back to another one */
+            if (cipher_hash(optarg) == 0)
+            {
+                fprintf(stderr, "%s + %s!\n", optarg, s_failure);
+                exit(EXIT_FAILURE);
+            }
             cipher_get_hash(local->ctx) = optarg;
         }
         break;
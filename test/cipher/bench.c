@@ -0,0 +1,140 @@
+/*!
+ @file bench.c
+ @brief Timing the storage profiles of cipher sqlite
+ @copyright Copyright (C) 2020-present tqfx, All rights reserved.
+*/
+
+#undef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+
+#include "cipher/sqlite.h"
+#include "cipher/cipher.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_COMMIT 2000
+#define BENCH_READ 100000
+#define BENCH_CHUNK 0x10000
+
+static double bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static void bench_text(char *buf, size_t i)
+{
+    sprintf(buf, "text-%08zu", i);
+}
+
+/* the rows in one load, the seconds are returned */
+static double bench_load(c_sqlite_s *sql, size_t rows)
+{
+    c_info_s *info = c_info_new();
+    char buf[0x20];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    cipher_set_hint(obj, "hint");
+    for (size_t i = 0; i != rows; ++i)
+    {
+        bench_text(buf, i);
+        cipher_set_text(obj, buf);
+        c_info_add(info, obj);
+    }
+    cipher_dtor(obj);
+
+    double t = bench_now();
+    c_sqlite_load_info(sql, info, BENCH_CHUNK, 0, 0);
+    t = bench_now() - t;
+    c_info_die(info);
+    return t;
+}
+
+/* a row per transaction */
+static double bench_commit(c_sqlite_s *sql, size_t rows)
+{
+    char buf[0x20];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    cipher_set_hint(obj, "commit");
+    double t = bench_now();
+    for (size_t i = 0; i != BENCH_COMMIT; ++i)
+    {
+        bench_text(buf, rows + i);
+        cipher_set_text(obj, buf);
+        c_sqlite_put_info(sql, obj);
+    }
+    t = bench_now() - t;
+    cipher_dtor(obj);
+    return t;
+}
+
+/* the rows are read in an order of their own, the same for every profile */
+static double bench_read(c_sqlite_s *sql, size_t rows)
+{
+    char buf[0x20];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    u64_t seed = 1;
+    size_t miss = 0;
+    double t = bench_now();
+    for (size_t i = 0; i != BENCH_READ; ++i)
+    {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        bench_text(buf, (size_t)(seed >> 16) % rows);
+        miss += c_sqlite_get_info(sql, buf, obj) != SQLITE_OK;
+    }
+    t = bench_now() - t;
+    cipher_dtor(obj);
+    if (miss)
+    {
+        printf("c_sqlite_get_info %zu\n", miss);
+    }
+    return t;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t rows = argc > 1 ? strtoul(argv[1], 0, 0) : 200000;
+    const char *fname = argc > 2 ? argv[2] : "bench.db";
+    if (rows == 0)
+    {
+        printf("USAGE: %s [rows] [path]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    static const char *name[] = {"interactive", "bulk-import", "read-only-mmap"};
+    printf("%-16s %12s %12s %12s\n", "", "load", "commits", "reads");
+    for (int i = C_SQLITE_INTERACTIVE; i != C_SQLITE_READ_ONLY_MMAP; ++i)
+    {
+        remove(fname);
+        c_sqlite_s sql[1];
+        if (c_sqlite_open(sql, fname, (c_sqlite_profile_e)i) != SQLITE_OK)
+        {
+            printf("c_sqlite_open %s\n", name[i]);
+            return EXIT_FAILURE;
+        }
+        c_sqlite_create_info(sql);
+        double load = bench_load(sql, rows);
+        double commit = bench_commit(sql, rows);
+        double read = bench_read(sql, rows);
+        c_sqlite_close(sql);
+        printf("%-16s %10.3f s %10.3f s %10.3f s\n", name[i], load, commit, read);
+    }
+    /* the store of the last profile is read as it is left */
+    c_sqlite_s sql[1];
+    if (c_sqlite_open(sql, fname, C_SQLITE_READ_ONLY_MMAP) != SQLITE_OK)
+    {
+        printf("c_sqlite_open %s\n", name[C_SQLITE_READ_ONLY_MMAP]);
+        return EXIT_FAILURE;
+    }
+    double read = bench_read(sql, rows);
+    c_sqlite_close(sql);
+    printf("%-16s %12s %12s %10.3f s\n", name[C_SQLITE_READ_ONLY_MMAP], "-", "-", read);
+
+    remove(fname);
+    return EXIT_SUCCESS;
+}
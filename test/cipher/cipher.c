@@ -320,8 +320,50 @@ static void test_v2(void)
     }
 }
 
+static void test_hash(void)
+{
+    static const char *const same[][3] = {
+        {"MD5", "md5", "Md5"},
+        {"SHA256", "sha-256", "Sha256"},
+        {"SHA3", "sha3", "SHA3-512"},
+        {"BLAKE2B", "blake2b", "BLAKE2b-512"},
+    };
+    for (size_t i = 0; i != sizeof(same) / sizeof(*same); ++i)
+    {
+        if (cipher_hash(same[i][0]) == 0 || cipher_hash(same[i][0]) != cipher_hash(same[i][1]) ||
+            cipher_hash(same[i][0]) != cipher_hash(same[i][2]))
+        {
+            printf("cipher_hash %s\n", same[i][0]);
+        }
+    }
+    if (cipher_hash("SHA") || cipher_hash("SHA2566") || cipher_hash("") || cipher_hash("md5 "))
+    {
+        printf("cipher_hash\n");
+    }
+
+    /* a known name is interned, an unknown one cannot generate */
+    char *out = 0;
+    cipher_s lhs[1];
+    cipher_s rhs[1];
+    cipher_ctor(lhs);
+    cipher_ctor(rhs);
+    cipher_set_text(lhs, text);
+    cipher_set_text(rhs, text);
+    cipher_set_hash(lhs, "sha-256");
+    cipher_set_hash(rhs, "SHA256");
+    if (lhs->hash != rhs->hash || cipher_set_hash(rhs, "SHA-0") == 0 ||
+        cipher_v1(lhs, word, &out) || cipher_v1(rhs, word, &out) != NOTFOUND)
+    {
+        printf("cipher_set_hash %s\n", rhs->hash);
+    }
+    free(out);
+    cipher_dtor(lhs);
+    cipher_dtor(rhs);
+}
+
 int main(void)
 {
     test_v1();
     test_v2();
+    test_hash();
 }
@@ -5,8 +5,10 @@
 */
 
 #include "cipher/info.h"
+#include "cipher/a/cols.h"
 
 #include <stdio.h>
+#include <string.h>
 
 static void test(size_t n)
 {
@@ -31,8 +33,370 @@ static void test(size_t n)
     c_info_die(ctx);
 }
 
+/* every text must be found at the first entry that holds it */
+static void check(c_info_s *ctx, const char *info)
+{
+    c_info_foreach(it, ctx)
+    {
+        if (cipher_get_text(it) == NULL)
+        {
+            continue;
+        }
+        cipher_s *obj = c_info_find(ctx, cipher_get_text(it));
+        cipher_s *top = ctx->head;
+        while (cipher_get_text(top) == NULL || strcmp(cipher_get_text(top), cipher_get_text(it)))
+        {
+            ++top;
+        }
+        if (obj != top)
+        {
+            printf("%s %s\n", info, cipher_get_text(it));
+        }
+    }
+}
+
+static void test_index(size_t n)
+{
+    c_info_s ctx[1];
+    cipher_s obj[1];
+    char buf[0x20];
+
+    c_info_ctor(ctx);
+    cipher_ctor(obj);
+    for (size_t i = 0; i != n; ++i)
+    {
+        sprintf(buf, "%zu", i * 7919 % n);
+        cipher_set_text(obj, buf);
+        cipher_set_hint(obj, buf);
+        c_info_add(ctx, obj);
+    }
+    /* adding an existing text replaces the entry */
+    cipher_set_text(obj, "0");
+    cipher_set_hint(obj, "zero");
+    c_info_add(ctx, obj);
+    if (c_info_num(ctx) != n || strcmp(cipher_get_hint(c_info_find(ctx, "0")), "zero"))
+    {
+        printf("c_info_add %zu\n", c_info_num(ctx));
+    }
+    check(ctx, "c_info_add");
+    /* an entry of the vector may be added again */
+    c_info_add(ctx, c_info_find(ctx, "0"));
+    if (c_info_num(ctx) != n || strcmp(cipher_get_hint(c_info_find(ctx, "0")), "zero"))
+    {
+        printf("c_info_add self\n");
+    }
+
+    c_info_swap(ctx, 1, n - 2);
+    check(ctx, "c_info_swap");
+    cipher_dtor(c_info_remove(ctx, n / 2));
+    check(ctx, "c_info_remove");
+    cipher_ctor(c_info_insert(ctx, n / 3));
+    cipher_set_text(c_info_at(ctx, n / 3), "inserted");
+    check(ctx, "c_info_insert");
+    cipher_dtor(c_info_pop(ctx));
+    check(ctx, "c_info_pop");
+
+    /* entries pushed directly are indexed on demand */
+    cipher_set_text(c_info_push(ctx), "pushed");
+    cipher_set_text(c_info_push(ctx), "pushed");
+    check(ctx, "c_info_push");
+
+    cipher_set_text(obj, "pushed");
+    c_info_del(ctx, obj);
+    if (c_info_find(ctx, "pushed"))
+    {
+        printf("c_info_del\n");
+    }
+    check(ctx, "c_info_del");
+
+    cipher_dtor(obj);
+    c_info_dtor(ctx);
+}
+
+static void test_slot(size_t n)
+{
+    c_info_s ctx[1];
+    cipher_s obj[1];
+    char buf[0x20];
+
+    c_info_ctor(ctx);
+    cipher_ctor(obj);
+    for (size_t i = 0; i != n; ++i)
+    {
+        sprintf(buf, "%zu", i);
+        cipher_set_text(obj, buf);
+        c_info_add(ctx, obj);
+    }
+    u64_t id = c_info_id(ctx, n / 2);
+    u64_t ok = c_info_id(ctx, n - 1);
+
+    /* the slots freed last are reused first */
+    c_info_erase(ctx, n / 2);
+    c_info_erase(ctx, n / 4);
+    if (c_info_get(ctx, id) || c_info_erase(ctx, n / 4) != FAILURE)
+    {
+        printf("c_info_erase %zu\n", n / 2);
+    }
+    cipher_set_text(obj, "reused");
+    c_info_add(ctx, obj);
+    if (c_info_num(ctx) != n || c_info_find(ctx, "reused") != c_info_at(ctx, n / 4))
+    {
+        printf("c_info_claim %zu\n", c_info_num(ctx));
+    }
+    check(ctx, "c_info_claim");
+
+    /* compact keeps the order */
+    if (c_info_compact(ctx) != 1 || c_info_num(ctx) != n - 1 || c_info_get(ctx, ok))
+    {
+        printf("c_info_compact %zu\n", c_info_num(ctx));
+    }
+    for (size_t i = 0, j = 0; i != n; ++i)
+    {
+        if (i == n / 2)
+        {
+            continue;
+        }
+        sprintf(buf, "%zu", i);
+        if (strcmp(cipher_get_text(c_info_at(ctx, j++)), i == n / 4 ? "reused" : buf))
+        {
+            printf("c_info_compact %s\n", buf);
+        }
+    }
+    check(ctx, "c_info_compact");
+    id = c_info_id(ctx, 0);
+    if (c_info_get(ctx, id) != c_info_at(ctx, 0))
+    {
+        printf("c_info_get\n");
+    }
+
+    /* a free slot follows its entry when they are swapped */
+    c_info_erase(ctx, 1);
+    c_info_swap(ctx, 1, 2);
+    cipher_set_text(obj, "swapped");
+    c_info_add(ctx, obj);
+    if (c_info_find(ctx, "swapped") != c_info_at(ctx, 2))
+    {
+        printf("c_info_swap free\n");
+    }
+    check(ctx, "c_info_swap");
+
+    cipher_dtor(obj);
+    c_info_dtor(ctx);
+}
+
+static void test_arena(size_t n)
+{
+    c_info_s ctx[1];
+    cipher_s obj[1];
+    char buf[0x20];
+
+    c_info_ctor(ctx);
+    c_info_use_arena(ctx);
+    cipher_ctor(obj);
+    for (size_t i = 0; i != n; ++i)
+    {
+        sprintf(buf, "%zu", i);
+        cipher_set_text(obj, buf);
+        cipher_set_hint(obj, buf);
+        c_info_add(ctx, obj);
+    }
+    /* a field in the arena is copied on write */
+    cipher_s *it = c_info_at(ctx, 1);
+    cipher_set_hint(it, "written");
+    c_info_erase(ctx, 0);
+    c_info_compact(ctx);
+    if (strcmp(cipher_get_hint(c_info_at(ctx, 0)), "written") ||
+        strcmp(cipher_get_text(c_info_at(ctx, n - 2)), buf))
+    {
+        printf("c_info_use_arena\n");
+    }
+    cipher_copy(obj, c_info_at(ctx, 0));
+    c_info_drop(ctx);
+    if (strcmp(cipher_get_text(obj), "1"))
+    {
+        printf("cipher_copy %s\n", cipher_get_text(obj));
+    }
+    c_info_add(ctx, obj);
+
+    cipher_dtor(obj);
+    c_info_dtor(ctx);
+}
+
+static void test_cols(size_t n)
+{
+    c_info_s ctx[1];
+    c_cols_s col[1];
+    char buf[0x20];
+
+    c_info_ctor(ctx);
+    c_cols_ctor(col);
+    for (size_t i = 0; i != n; ++i)
+    {
+        cipher_s *obj = c_info_push(ctx);
+        sprintf(buf, "%zu", i);
+        cipher_set_text(obj, buf);
+        cipher_set_hash(obj, i % 3 ? "sha256" : "nope");
+        cipher_set_size(obj, (uint_t)i % 32);
+    }
+    c_info_erase(ctx, 1);
+    c_cols_build(col, ctx);
+    if (c_cols_num(col) != n - 1 || col->pos[1] != 2 || strcmp(c_cols_text(col, 1), "2") ||
+        c_cols_len(col, n - 2) != strlen(buf) || col->hash[0] != 0xFF ||
+        col->hash[1] != cipher_hash_id("SHA256") || col->size[n - 2] != (n - 1) % 32)
+    {
+        printf("c_cols_build %zu\n", c_cols_num(col));
+    }
+
+    /* every row whose text holds "7" */
+    size_t row = c_cols_next(col, 0, "7");
+    for (size_t i = 0; i != n; ++i)
+    {
+        sprintf(buf, "%zu", i);
+        if (i == 1 || strchr(buf, '7') == NULL)
+        {
+            continue;
+        }
+        if (row == c_cols_num(col) || col->pos[row] != i)
+        {
+            printf("c_cols_next %zu\n", i);
+            break;
+        }
+        row = c_cols_next(col, row + 1, "7");
+    }
+    if (row != c_cols_num(col) || c_cols_next(col, 0, "x") != row || c_cols_next(col, 5, "") != 5)
+    {
+        printf("c_cols_next\n");
+    }
+
+    c_cols_dtor(col);
+    c_info_dtor(ctx);
+}
+
+static void test_fuzzy(size_t n)
+{
+    static const char *const texts[] = {"GitHub", "gmail", "big-hub", "go/hub", "shopping"};
+    c_info_s ctx[1];
+    c_cols_s col[1];
+    c_cols_hit_s top[4];
+    char buf[0x20];
+
+    c_info_ctor(ctx);
+    c_cols_ctor(col);
+    for (size_t i = 0; i != n; ++i)
+    {
+        cipher_s *obj = c_info_push(ctx);
+        sprintf(buf, "%zu", i);
+        cipher_set_text(obj, i < sizeof(texts) / sizeof(*texts) ? texts[i] : buf);
+    }
+    c_cols_build(col, ctx);
+
+    /* the bytes at the start of a word score more than the ones inside it */
+    size_t num = c_cols_fuzzy(col, "gh", top, 4);
+    if (num != 3 || top[0].row != 3 || top[1].row != 0 || top[2].row != 2)
+    {
+        printf("c_cols_fuzzy gh %zu\n", num);
+    }
+    num = c_cols_fuzzy(col, "HUB", top, 4);
+    if (num != 3 || top[0].score < top[1].score || top[1].score < top[2].score)
+    {
+        printf("c_cols_fuzzy HUB %zu\n", num);
+    }
+    /* the best k of many rows, equal scores in the order of rows */
+    num = c_cols_fuzzy(col, "99", top, 4);
+    if (num != 4 || strcmp(c_cols_text(col, top[0].row), "99") || top[1].row != top[2].row - 1)
+    {
+        printf("c_cols_fuzzy 99 %zu\n", num);
+    }
+    if (c_cols_fuzzy(col, "mq", top, 4) != 0 || c_cols_fuzzy(col, "", top, 4) != 4 || top[3].row != 3)
+    {
+        printf("c_cols_fuzzy\n");
+    }
+
+    c_cols_dtor(col);
+    c_info_dtor(ctx);
+}
+
+/* the index must give the entries that a scan would give */
+static void check_search(c_info_s *ctx, const char *str, const char *info)
+{
+    size_t idx = c_info_search(ctx, str, 0);
+    c_info_forenum(i, ctx)
+    {
+        cstr_t text = cipher_get_text(c_info_at(ctx, i));
+        if (text == NULL || strstr(text, str) == NULL)
+        {
+            continue;
+        }
+        if (idx != i)
+        {
+            printf("%s %s %zu\n", info, str, i);
+            return;
+        }
+        idx = c_info_search(ctx, str, idx + 1);
+    }
+    if (idx != c_info_num(ctx))
+    {
+        printf("%s %s\n", info, str);
+    }
+}
+
+static void test_search(size_t n)
+{
+    static const char *const strs[] = {"", "7", "12", "123", "3456", "9999", "x"};
+    c_info_s ctx[1];
+    cipher_s obj[1];
+    char buf[0x20];
+
+    c_info_ctor(ctx);
+    cipher_ctor(obj);
+    cipher_set_hash(obj, "md5");
+    for (size_t i = 0; i != n; ++i)
+    {
+        sprintf(buf, "%zu", i * 7);
+        cipher_set_text(obj, buf);
+        c_info_add(ctx, obj);
+    }
+    for (size_t i = 0; i != sizeof(strs) / sizeof(*strs); ++i)
+    {
+        check_search(ctx, strs[i], "c_info_search");
+    }
+
+    /* the index follows the entries that come, go and move */
+    c_info_erase(ctx, 16);
+    c_info_erase(ctx, 176);
+    cipher_set_text(obj, "123123");
+    c_info_add(ctx, obj);
+    cipher_set_text(obj, "x3456");
+    c_info_add(ctx, obj);
+    c_info_swap(ctx, 3, n - 1);
+    c_info_swap(ctx, 5, 0x20);
+    cipher_dtor(c_info_pop_back(ctx));
+    cipher_dtor(c_info_remove(ctx, n - 8));
+    for (size_t i = 0; i != sizeof(strs) / sizeof(*strs); ++i)
+    {
+        check_search(ctx, strs[i], "c_info_search update");
+    }
+    cipher_s *it = c_info_insert(ctx, 2);
+    cipher_ctor(it);
+    cipher_set_text(it, "9999");
+    c_info_compact(ctx);
+    for (size_t i = 0; i != sizeof(strs) / sizeof(*strs); ++i)
+    {
+        check_search(ctx, strs[i], "c_info_search move");
+    }
+
+    cipher_dtor(obj);
+    c_info_dtor(ctx);
+}
+
 int main(void)
 {
     test(0xFF);
+    test_index(0x1000);
+    test_slot(0x100);
+    test_arena(0x4000);
+    test_cols(0x1000);
+    test_search(0x1000);
+    test_fuzzy(0x1000);
     return 0;
 }
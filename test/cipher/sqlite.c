@@ -5,13 +5,681 @@
 */
 
 #include "cipher/sqlite.h"
+#include "cipher/writer.h"
+#include "cipher/cipher.h"
 
 #include <stdio.h>
+#include <string.h>
+
+static void test_apply(void)
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+    c_sqlite_create_word(sql);
+    c_sqlite_create_info(sql);
+
+    char buf[0x20];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    c_info_s *info = c_info_new();
+    for (size_t i = 0; i != 0x100; ++i)
+    {
+        sprintf(buf, "%zu", i);
+        cipher_set_text(c_info_push(info), buf);
+    }
+    c_sqlite_add_info(sql, info);
+
+    /* the changes of a few entries are written row by row */
+    cipher_set_text(obj, "1");
+    cipher_set_hint(obj, "hint");
+    c_info_add(info, obj);
+    cipher_set_text(obj, "new");
+    c_info_add(info, obj);
+    c_info_del(info, c_info_at(info, 2));
+    c_info_erase(info, 3);
+    if (c_log_is_all(c_info_log(info)) || c_log_num(c_info_log(info)) != 4)
+    {
+        printf("c_info_mark %zu\n", c_log_num(c_info_log(info)));
+    }
+    c_sqlite_apply_changes(sql, 0, info);
+    if (c_log_num(c_info_log(info)))
+    {
+        printf("c_sqlite_apply_changes\n");
+    }
+
+    c_info_s *out = c_info_new();
+    c_sqlite_out_info(sql, out);
+    cipher_s *it = c_info_find(out, "1");
+    if (c_info_num(out) != 0x100 - 1 || c_info_find(out, "2") || c_info_find(out, "3") ||
+        c_info_find(out, "new") == 0 || it == 0 || strcmp(cipher_get_hint(it), "hint"))
+    {
+        printf("c_sqlite_apply_changes 0x%zX\n", c_info_num(out));
+    }
+
+    /* the statements of the handle are reset and bound again */
+    cipher_set_text(obj, "1");
+    cipher_set_hint(obj, "again");
+    c_info_add(info, obj);
+    c_info_del(info, c_info_find(info, "4"));
+    c_sqlite_apply_changes(sql, 0, info);
+    c_info_dtor(out);
+    c_info_ctor(out);
+    c_sqlite_out_info(sql, out);
+    it = c_info_find(out, "1");
+    if (c_info_num(out) != 0x100 - 2 || c_info_find(out, "4") ||
+        it == 0 || strcmp(cipher_get_hint(it), "again"))
+    {
+        printf("c_sqlite_stmt 0x%zX\n", c_info_num(out));
+    }
+
+    /* a failed statement rolls back the words as well and keeps both journals */
+    str_s str[1];
+    str_ctor(str);
+    str_puts(str, "word");
+    c_word_s *word = c_word_new();
+    c_word_add(word, str);
+    c_sqlite_create_word(sql);
+    sqlite3_exec(db, "drop table info;", 0, 0, 0);
+    cipher_set_text(obj, "5");
+    c_info_add(info, obj);
+    if (c_sqlite_apply_changes(sql, word, info) == SQLITE_OK || c_sqlite_count_word(sql) ||
+        c_log_is_all(c_word_log(word)) == 0 || c_log_num(c_info_log(info)) != 1 ||
+        sqlite3_get_autocommit(db) == 0)
+    {
+        printf("c_sqlite_apply_changes rollback\n");
+    }
+    c_sqlite_create_info(sql);
+    if (c_sqlite_apply_changes(sql, word, info) != SQLITE_OK || c_sqlite_count_word(sql) != 1 ||
+        c_sqlite_count_info(sql) != 1 || c_log_is_all(c_word_log(word)) || c_log_num(c_info_log(info)))
+    {
+        printf("c_sqlite_apply_changes again\n");
+    }
+    c_word_die(word);
+    str_dtor(str);
+
+    c_info_die(out);
+    c_info_die(info);
+    cipher_dtor(obj);
+    c_sqlite_dtor(sql);
+    sqlite3_close(db);
+}
+
+static void test_stmt(void)
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+
+    /* without the table the statements fail to compile, and so do the calls */
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    cipher_set_text(obj, "text");
+    c_info_s *info = c_info_new();
+    c_info_add(info, obj);
+    if (c_sqlite_put_info(sql, obj) == SQLITE_OK || c_sqlite_load_info(sql, info, 0, 0, 0) == SQLITE_OK ||
+        c_sqlite_get_info(sql, "text", obj) == SQLITE_OK || c_sqlite_out_info(sql, info) == SQLITE_OK)
+    {
+        printf("c_sqlite_stmt\n");
+    }
+
+    /* a statement that failed is compiled again on its next use */
+    c_sqlite_create_info(sql);
+    if (c_sqlite_put_info(sql, obj) != SQLITE_OK || c_sqlite_count_info(sql) != 1)
+    {
+        printf("c_sqlite_stmt again\n");
+    }
+
+    c_info_die(info);
+    cipher_dtor(obj);
+    c_sqlite_dtor(sql);
+    sqlite3_close(db);
+}
+
+static void test_lazy(void)
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+    c_sqlite_create_info(sql);
+
+    char buf[0x20];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    for (size_t i = 0; i != 0x10; ++i)
+    {
+        sprintf(buf, "%02zu", i);
+        cipher_set_text(obj, buf);
+        c_sqlite_put_info(sql, obj);
+    }
+    cipher_set_hint(obj, "hint");
+    c_sqlite_put_info(sql, obj);
+    if (c_sqlite_count_info(sql) != 0x10)
+    {
+        printf("c_sqlite_put_info 0x%zX\n", c_sqlite_count_info(sql));
+    }
+
+    cipher_s *it = cipher_new();
+    if (c_sqlite_get_info(sql, "15", it) != SQLITE_OK || strcmp(cipher_get_hint(it), "hint") ||
+        c_sqlite_get_info(sql, "16", it) != SQLITE_NOTFOUND)
+    {
+        printf("c_sqlite_get_info\n");
+    }
+    if (c_sqlite_remove_info(sql, "03") != SQLITE_OK || c_sqlite_remove_info(sql, "03") != SQLITE_NOTFOUND)
+    {
+        printf("c_sqlite_remove_info\n");
+    }
+
+    c_info_s *out = c_info_new();
+    c_sqlite_page_info(sql, 2, 4, out);
+    if (c_info_num(out) != 4 || strcmp(cipher_get_text(c_info_at(out, 0)), "02") ||
+        strcmp(cipher_get_text(c_info_at(out, 1)), "04"))
+    {
+        printf("c_sqlite_page_info 0x%zX\n", c_info_num(out));
+    }
+
+    c_info_die(out);
+    cipher_die(it);
+    cipher_dtor(obj);
+    c_sqlite_dtor(sql);
+    sqlite3_close(db);
+}
+
+static int test_search_(void *arg, size_t idx, const cipher_s *it)
+{
+    size_t *sum = (size_t *)arg;
+    sum[0] += 1;
+    sum[1] += idx;
+    (void)it;
+    return 0;
+}
+
+static void test_search(void)
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+    c_sqlite_create_info(sql);
+
+    /* in the order of text, the third is "abc" + two CJK characters + "def" in UTF-8 */
+    const char *text[] = {"ab1", "ab2", "abc\xE4\xB8\xAD\xE6\x96\x87" "def", "b", "xab1x"};
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    for (size_t i = 0; i != sizeof(text) / sizeof(*text); ++i)
+    {
+        cipher_set_text(obj, text[i]);
+        cipher_set_hint(obj, i == 3 ? "has ab1" : "");
+        c_sqlite_put_info(sql, obj);
+    }
+
+    size_t sum[2] = {0, 0};
+    c_sqlite_prefix_info(sql, "ab", test_search_, sum);
+    if (sum[0] != 3 || sum[1] != 0 + 1 + 2)
+    {
+        printf("c_sqlite_prefix_info %zu %zu\n", sum[0], sum[1]);
+    }
+    sum[0] = sum[1] = 0;
+    /* a hint is not searched */
+    c_sqlite_match_info(sql, "ab1", test_search_, sum);
+    if (sum[0] != 2 || sum[1] != 0 + 4)
+    {
+        printf("c_sqlite_match_info %zu %zu\n", sum[0], sum[1]);
+    }
+    sum[0] = sum[1] = 0;
+    c_sqlite_match_info(sql, "ab", test_search_, sum);
+    if (sum[0] != 4 || sum[1] != 0 + 1 + 2 + 4)
+    {
+        printf("c_sqlite_match_info %zu %zu\n", sum[0], sum[1]);
+    }
+    /* two characters of six bytes are less than a trigram, so are two of four bytes */
+    sum[0] = sum[1] = 0;
+    c_sqlite_match_info(sql, "\xE4\xB8\xAD\xE6\x96\x87", test_search_, sum);
+    if (sum[0] != 1 || sum[1] != 2)
+    {
+        printf("c_sqlite_match_info %zu %zu\n", sum[0], sum[1]);
+    }
+    sum[0] = sum[1] = 0;
+    c_sqlite_match_info(sql, "\xE6\x96\x87" "d", test_search_, sum);
+    if (sum[0] != 1 || sum[1] != 2)
+    {
+        printf("c_sqlite_match_info %zu %zu\n", sum[0], sum[1]);
+    }
+    /* the walk starts at the first match */
+    sum[0] = sum[1] = 0;
+    c_sqlite_match_info(sql, "x", test_search_, sum);
+    if (sum[0] != 1 || sum[1] != 4)
+    {
+        printf("c_sqlite_match_info %zu %zu\n", sum[0], sum[1]);
+    }
+
+    cipher_dtor(obj);
+    c_sqlite_dtor(sql);
+    sqlite3_close(db);
+}
+
+static int test_load_(void *arg, size_t idx, size_t num, int ok)
+{
+    size_t *sum = (size_t *)arg;
+    sum[0] += num;
+    sum[1] += ok == SQLITE_OK ? 0 : idx + 1;
+    return 0;
+}
+
+static void test_load(void)
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+    c_sqlite_create_word(sql);
+    c_sqlite_create_info(sql);
+    /* the chunk that holds it is rolled back as a whole */
+    sqlite3_exec(db, "create trigger bad before insert on info when new.text = 'bad' "
+                     "begin select raise(abort, 'bad'); end;",
+                 0, 0, 0);
+
+    char buf[0x20];
+    c_word_s *word = c_word_new();
+    c_info_s *info = c_info_new();
+    for (size_t i = 0; i != 0x1000; ++i)
+    {
+        sprintf(buf, "%zu", i);
+        str_puts(c_word_push(word), buf);
+        cipher_set_text(c_info_push(info), i == 0x123 ? "bad" : buf);
+    }
+    c_word_push(word);
+    cipher_set_hint(c_info_at(info, 0), "hint");
+
+    size_t sum[2] = {0, 0};
+    if (c_sqlite_load_word(sql, word, 0, test_load_, sum) != SQLITE_OK ||
+        c_sqlite_count_word(sql) != 0x1000 || sum[0] != 0x1000 + 1 || sum[1])
+    {
+        printf("c_sqlite_load_word 0x%zX\n", c_sqlite_count_word(sql));
+    }
+    sum[0] = sum[1] = 0;
+    if (c_sqlite_load_info(sql, info, 0x100, test_load_, sum) == SQLITE_OK ||
+        c_sqlite_count_info(sql) != 0x1000 - 0x100 || sum[0] != 0x1000 || sum[1] != 0x100 + 1)
+    {
+        printf("c_sqlite_load_info 0x%zX\n", c_sqlite_count_info(sql));
+    }
+
+    /* the entries that are there are updated */
+    sqlite3_exec(db, "drop trigger bad;", 0, 0, 0);
+    cipher_set_hint(c_info_at(info, 0), "next");
+    c_sqlite_load_info(sql, info, 0, 0, 0);
+    cipher_s *it = cipher_new();
+    if (c_sqlite_count_info(sql) != 0x1000 || c_sqlite_get_info(sql, "0", it) ||
+        strcmp(cipher_get_hint(it), "next"))
+    {
+        printf("c_sqlite_load_info 0x%zX\n", c_sqlite_count_info(sql));
+    }
+
+    cipher_die(it);
+    c_word_die(word);
+    c_info_die(info);
+    c_sqlite_dtor(sql);
+    sqlite3_close(db);
+}
+
+static void test_profile(void)
+{
+    const char *fname = "profile.db";
+    remove(fname);
+    c_sqlite_s sql[1];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    cipher_set_text(obj, "text");
+
+    c_sqlite_open(sql, fname, C_SQLITE_BULK_IMPORT);
+    c_sqlite_create_info(sql);
+    c_sqlite_put_info(sql, obj);
+    c_sqlite_close(sql);
+
+    if (c_sqlite_open(sql, fname, C_SQLITE_INTERACTIVE) == SQLITE_OK)
+    {
+        sqlite3_stmt *stmt = 0;
+        sqlite3_prepare_v2(c_sqlite_db(sql), "pragma journal_mode;", -1, &stmt, 0);
+        if (sqlite3_step(stmt) != SQLITE_ROW || strcmp((const char *)sqlite3_column_text(stmt, 0), "wal"))
+        {
+            printf("C_SQLITE_INTERACTIVE\n");
+        }
+        sqlite3_finalize(stmt);
+        sqlite3_prepare_v2(c_sqlite_db(sql), "pragma busy_timeout;", -1, &stmt, 0);
+        if (sqlite3_step(stmt) != SQLITE_ROW || sqlite3_column_int(stmt, 0) <= 0)
+        {
+            printf("C_SQLITE_INTERACTIVE busy_timeout\n");
+        }
+        sqlite3_finalize(stmt);
+    }
+    c_sqlite_close(sql);
+
+    c_sqlite_open(sql, fname, C_SQLITE_READ_ONLY_MMAP);
+    cipher_set_text(obj, "next");
+    if (c_sqlite_count_info(sql) != 1 || c_sqlite_put_info(sql, obj) == SQLITE_OK)
+    {
+        printf("C_SQLITE_READ_ONLY_MMAP\n");
+    }
+    c_sqlite_close(sql);
+
+    cipher_dtor(obj);
+    /* a reader can not remove the files of the journal */
+    remove("profile.db-wal");
+    remove("profile.db-shm");
+    remove(fname);
+}
+
+static void test_rule(void)
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+    c_sqlite_create_rule(sql);
+
+    c_rule_s *in = c_rule_new();
+    rule_s *it = c_rule_push(in);
+    str_puts(it->r + 0, "kise");
+    str_puts(it->r + 1, "snow");
+    str_puts(it->r + 2, "rule");
+    it = c_rule_push(in);
+    str_puts(it->r + 0, "only");
+    c_sqlite_add_rule(sql, in);
+    c_sqlite_add_rule(sql, in);
+
+    c_rule_s *out = c_rule_new();
+    c_sqlite_out_rule(sql, out);
+    if (c_rule_num(out) != 2 || strcmp(str_val(c_rule_at(out, 0)->r + 2), "rule") ||
+        str_len(c_rule_at(out, 0)->r + 3) || str_len(c_rule_at(out, 1)->r + 1))
+    {
+        printf("c_sqlite_add_rule 0x%zX\n", c_rule_num(out));
+    }
+
+    /* the key states from the cache give the same output as those derived from the rule */
+    cipher_s ctx[1];
+    cipher_ctor(ctx);
+    cipher_set_text(ctx, "test");
+    cipher_set_hash(ctx, "SHA256");
+    char *want, *got;
+    it = c_rule_at(out, 0);
+    cipher_v2_init(str_val(it->r + 0), str_val(it->r + 1), str_val(it->r + 2), str_val(it->r + 3));
+    cipher_v2(ctx, "word", &want);
+    for (int i = 0; i != 3; ++i)
+    {
+        if (i == 2)
+        {
+            /* a state that can not be imported is derived and stored again */
+            sqlite3_exec(db, "update rule_key set state=x'00';", 0, 0, 0);
+        }
+        if (c_sqlite_key_rule(sql, it, "SHA-256") != SQLITE_OK)
+        {
+            printf("c_sqlite_key_rule %i\n", i);
+        }
+        cipher_v2(ctx, "word", &got);
+        if (strcmp(want, got))
+        {
+            printf("c_sqlite_key_rule %s %s\n", want, got);
+        }
+        free(got);
+    }
+    if (c_sqlite_key_rule(sql, it, "none") != SQLITE_NOTFOUND)
+    {
+        printf("c_sqlite_key_rule none\n");
+    }
+    free(want);
+    cipher_dtor(ctx);
+
+    c_rule_drop(in);
+    c_rule_push(in);
+    str_puts(c_rule_at(in, 0)->r + 0, "only");
+    c_sqlite_del_rule(sql, in);
+    c_rule_drop(out);
+    c_sqlite_out_rule(sql, out);
+    if (c_rule_num(out) != 1)
+    {
+        printf("c_sqlite_del_rule 0x%zX\n", c_rule_num(out));
+    }
+
+    c_rule_die(out);
+    c_rule_die(in);
+    c_sqlite_dtor(sql);
+    sqlite3_close(db);
+}
+
+static void test_writer(void)
+{
+    const char *fname = "writer.db";
+    remove(fname);
+    c_writer_s ctx[1];
+    if (c_writer_open(ctx, fname, 0x10, 10) != SQLITE_OK)
+    {
+        printf("c_writer_open\n");
+        return;
+    }
+
+    char buf[0x20];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    for (size_t i = 0; i != 0x40; ++i)
+    {
+        sprintf(buf, "%02zu", i);
+        cipher_set_text(obj, buf);
+        c_writer_put_info(ctx, obj);
+        c_writer_put_word(ctx, buf);
+    }
+    /* the last change of a key wins */
+    c_writer_del_info(ctx, "00");
+    c_writer_del_word(ctx, "01");
+    cipher_set_text(obj, "00");
+    cipher_set_hint(obj, "hint");
+    c_writer_put_info(ctx, obj);
+    c_writer_del_info(ctx, "02");
+    c_writer_del_info(ctx, "none");
+    if (c_writer_flush(ctx) != SQLITE_OK)
+    {
+        printf("c_writer_flush\n");
+    }
+
+    c_sqlite_s sql[1];
+    c_sqlite_open(sql, fname, C_SQLITE_READ_ONLY_MMAP);
+    cipher_s *it = cipher_new();
+    if (c_sqlite_count_info(sql) != 0x3F || c_sqlite_count_word(sql) != 0x3F ||
+        c_sqlite_get_info(sql, "00", it) != SQLITE_OK || strcmp(cipher_get_hint(it), "hint"))
+    {
+        printf("c_writer_flush 0x%zX 0x%zX\n", c_sqlite_count_info(sql), c_sqlite_count_word(sql));
+    }
+
+    /* the journal of info is queued, an entry that is gone is deleted */
+    c_info_s *info = c_info_new();
+    c_sqlite_out_info(sql, info);
+    cipher_set_text(obj, "03");
+    c_info_add(info, obj);
+    cipher_set_text(obj, "04");
+    c_info_add(info, obj);
+    c_info_del(info, obj);
+    c_writer_apply(ctx, 0, info);
+    if (c_log_num(c_info_log(info)) || c_writer_close(ctx) != SQLITE_OK)
+    {
+        printf("c_writer_apply\n");
+    }
+    if (c_sqlite_count_info(sql) != 0x3E || c_sqlite_get_info(sql, "04", it) != SQLITE_NOTFOUND)
+    {
+        printf("c_writer_close 0x%zX\n", c_sqlite_count_info(sql));
+    }
+
+    c_info_die(info);
+    cipher_die(it);
+    cipher_dtor(obj);
+    c_sqlite_close(sql);
+    remove("writer.db-wal");
+    remove("writer.db-shm");
+    remove(fname);
+}
+
+static int test_backup_step(void *arg, int remaining, int pagecount)
+{
+    int *step = (int *)arg;
+    if (remaining > pagecount)
+    {
+        printf("c_sqlite_backup %i %i\n", remaining, pagecount);
+    }
+    return step[1] && ++step[0] == step[1];
+}
+
+static void test_writer_busy(void)
+{
+    const char *fname = "busy.db";
+    remove(fname);
+    c_writer_s ctx[1];
+    if (c_writer_open(ctx, fname, 0x10, 10) != SQLITE_OK)
+    {
+        printf("c_writer_open\n");
+        return;
+    }
+    sqlite3_busy_timeout(c_sqlite_db(ctx->__sql), 0);
+
+    /* a batch that meets a lock is written again with the next one */
+    sqlite3 *db;
+    sqlite3_open(fname, &db);
+    sqlite3_exec(db, "begin immediate;", 0, 0, 0);
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    cipher_set_text(obj, "00");
+    c_writer_put_info(ctx, obj);
+    int ok = c_writer_flush(ctx);
+    if ((ok & 0xFF) != SQLITE_BUSY)
+    {
+        printf("c_writer_flush %s\n", sqlite3_errstr(ok));
+    }
+    sqlite3_exec(db, "commit;", 0, 0, 0);
+    cipher_set_text(obj, "01");
+    c_writer_put_info(ctx, obj);
+    if (c_writer_flush(ctx) != SQLITE_OK)
+    {
+        printf("c_writer_flush\n");
+    }
+    c_sqlite_s sql[1];
+    c_sqlite_open(sql, fname, C_SQLITE_READ_ONLY_MMAP);
+    if (c_sqlite_count_info(sql) != 2)
+    {
+        printf("c_writer_flush 0x%zX\n", c_sqlite_count_info(sql));
+    }
+
+    /* the last batch is given up */
+    sqlite3_exec(db, "begin immediate;", 0, 0, 0);
+    cipher_set_text(obj, "02");
+    c_writer_put_info(ctx, obj);
+    ok = c_writer_close(ctx);
+    sqlite3_exec(db, "commit;", 0, 0, 0);
+    if ((ok & 0xFF) != SQLITE_BUSY || c_sqlite_count_info(sql) != 2)
+    {
+        printf("c_writer_close %s 0x%zX\n", sqlite3_errstr(ok), c_sqlite_count_info(sql));
+    }
+
+    cipher_dtor(obj);
+    c_sqlite_close(sql);
+    sqlite3_close(db);
+    remove("busy.db-wal");
+    remove("busy.db-shm");
+    remove(fname);
+}
+
+static void test_backup(void)
+{
+    sqlite3 *db;
+    sqlite3_open(":memory:", &db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+    c_sqlite_create_info(sql);
+
+    char buf[0x20];
+    cipher_s obj[1];
+    cipher_ctor(obj);
+    cipher_set_hint(obj, "hint");
+    for (size_t i = 0; i != 0x1000; ++i)
+    {
+        sprintf(buf, "%04zu", i);
+        cipher_set_text(obj, buf);
+        c_sqlite_put_info(sql, obj);
+    }
+    cipher_dtor(obj);
+
+    int step[2] = {0, 1};
+    remove("backup.db");
+    if (c_sqlite_backup(sql, "backup.db", 1, test_backup_step, step) != SQLITE_ABORT)
+    {
+        printf("c_sqlite_backup abort\n");
+    }
+    step[1] = 0;
+    if (c_sqlite_backup(sql, "backup.db", 1, test_backup_step, step) != SQLITE_OK)
+    {
+        printf("c_sqlite_backup\n");
+    }
+    remove("vacuum.db");
+    if (c_sqlite_vacuum(sql, "vacuum.db") != SQLITE_OK)
+    {
+        printf("c_sqlite_vacuum\n");
+    }
+    c_sqlite_dtor(sql);
+    sqlite3_close(db);
+
+    c_sqlite_open(sql, "backup.db", C_SQLITE_READ_ONLY_MMAP);
+    if (c_sqlite_count_info(sql) != 0x1000)
+    {
+        printf("c_sqlite_backup 0x%zX\n", c_sqlite_count_info(sql));
+    }
+    c_sqlite_close(sql);
+    c_sqlite_open(sql, "vacuum.db", C_SQLITE_READ_ONLY_MMAP);
+    if (c_sqlite_count_info(sql) != 0x1000)
+    {
+        printf("c_sqlite_vacuum 0x%zX\n", c_sqlite_count_info(sql));
+    }
+    c_sqlite_close(sql);
+    remove("backup.db");
+    remove("vacuum.db");
+
+    /* a transaction of the source makes the backup fail at once */
+    remove("source.db");
+    c_sqlite_open(sql, "source.db", C_SQLITE_INTERACTIVE);
+    c_sqlite_init(sql);
+    cipher_ctor(obj);
+    cipher_set_text(obj, "text");
+    c_sqlite_put_info(sql, obj);
+    cipher_dtor(obj);
+    if (c_sqlite_backup(sql, "backup.db", 0, 0, 0) != SQLITE_LOCKED)
+    {
+        printf("c_sqlite_backup locked\n");
+    }
+    c_sqlite_exit(sql);
+    if (c_sqlite_backup(sql, "backup.db", 0, 0, 0) != SQLITE_OK)
+    {
+        printf("c_sqlite_backup exit\n");
+    }
+    c_sqlite_close(sql);
+    remove("source.db-wal");
+    remove("source.db-shm");
+    remove("source.db");
+    remove("backup.db");
+}
 
 int main(int argc, char *argv[])
 {
     const char *fname = "sqlite.db";
 
+    test_apply();
+    test_stmt();
+    test_lazy();
+    test_search();
+    test_load();
+    test_profile();
+    test_rule();
+    test_writer();
+    test_writer_busy();
+    test_backup();
+
     if (argc > 1)
     {
         fname = argv[argc - 1];
@@ -25,11 +693,13 @@ int main(int argc, char *argv[])
         exit(EXIT_FAILURE);
     }
 
-    c_sqlite_init(db);
+    c_sqlite_s sql[1];
+    c_sqlite_ctor(sql, db);
+    c_sqlite_init(sql);
     c_word_s *word = c_word_new();
     c_info_s *info = c_info_new();
-    c_sqlite_out_word(db, word);
-    c_sqlite_out_info(db, info);
+    c_sqlite_out_word(sql, word);
+    c_sqlite_out_info(sql, info);
 
     printf("0x%zX 0x%zX\n", c_word_num(word), c_info_num(info));
 
@@ -51,13 +721,14 @@ int main(int argc, char *argv[])
         cipher_set_text(obj, str_val(str));
     }
 
-    c_sqlite_begin(db);
-    c_sqlite_add_word(db, word);
-    c_sqlite_add_info(db, info);
-    c_sqlite_commit(db);
+    c_sqlite_begin(sql);
+    c_sqlite_add_word(sql, word);
+    c_sqlite_add_info(sql, info);
+    c_sqlite_commit(sql);
 
     c_word_die(word);
     c_info_die(info);
+    c_sqlite_dtor(sql);
 
     return sqlite3_close(db);
 }
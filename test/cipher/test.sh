@@ -15,6 +15,7 @@ cwd=$(dirname $bin)
 base=$(basename $bin)
 json=$cwd/$base.json
 name=$cwd/$base.db
+copy=$cwd/$base.copy.db
 
 rm -f $name
 $bin -f $name -s -k* -p*
@@ -37,4 +38,14 @@ rm -f $name
 $bin -f $name --import $json
 $bin -f $name -s -k* -p*
 
+# a snapshot of a new store, which is opened for writes, and of a store that is only read
+rm -f $name $copy
+$bin -f $name --export $copy
+$bin -f $copy -s -k* -p*
+rm -f $copy
+$bin -f $name --import $json
+$bin -f $name --export $copy
+$bin -f $copy -s -k* -p*
+rm -f $copy $copy-wal $copy-shm
+
 rm -f $name
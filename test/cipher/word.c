@@ -21,8 +21,208 @@ static void test(size_t n)
     c_word_die(ctx);
 }
 
+static void test_set(size_t n)
+{
+    c_word_s ctx[1];
+    str_s obj[1];
+
+    c_word_ctor(ctx);
+    str_ctor(obj);
+    for (size_t k = 0; k != 2; ++k)
+    {
+        for (size_t i = 0; i != n; ++i)
+        {
+            str_dtor(obj);
+            str_printf(obj, "%zu", i * 7919 % n);
+            c_word_add(ctx, obj);
+        }
+    }
+    /* adding an existing word leaves the store as it was */
+    if (c_word_num(ctx) != n)
+    {
+        printf("c_word_add %zu\n", c_word_num(ctx));
+    }
+
+    str_dtor(obj);
+    str_printf(obj, "%zu", n / 2);
+    str_s *it = c_word_find(ctx, str_val(obj));
+    size_t idx = (size_t)(it - c_word_ptr(ctx));
+    c_word_del(ctx, obj);
+    if (c_word_find(ctx, str_val(obj)) || c_word_num(ctx) != n || str_val(c_word_at(ctx, idx)))
+    {
+        printf("c_word_del %zu\n", idx);
+    }
+
+    /* the indices of the other words are kept */
+    for (size_t i = 0; i != n; ++i)
+    {
+        char buf[0x20];
+        sprintf(buf, "%zu", i * 7919 % n);
+        it = c_word_find(ctx, buf);
+        if ((it == NULL) != (i * 7919 % n == n / 2) || (it && it != c_word_at(ctx, i)))
+        {
+            printf("c_word_find %s\n", buf);
+        }
+    }
+
+    str_dtor(obj);
+    c_word_dtor(ctx);
+}
+
+static void test_slot(size_t n)
+{
+    c_word_s ctx[1];
+    str_s obj[1];
+
+    c_word_ctor(ctx);
+    str_ctor(obj);
+    for (size_t i = 0; i != n; ++i)
+    {
+        str_dtor(obj);
+        str_printf(obj, "%zu", i);
+        c_word_add(ctx, obj);
+    }
+    u64_t id = c_word_id(ctx, 1);
+
+    /* a deleted word leaves a slot that the next word takes */
+    c_word_erase(ctx, 1);
+    /* a slot given back is free again and the journal is left as it was */
+    size_t log = c_log_num(c_word_log(ctx));
+    str_s *it = c_word_claim(ctx);
+    str_printf(it, "unclaimed");
+    c_word_unclaim(ctx, it);
+    if (c_word_claim(ctx) != it || c_log_num(c_word_log(ctx)) != log || c_word_find(ctx, "unclaimed"))
+    {
+        printf("c_word_unclaim %zu\n", c_word_num(ctx));
+    }
+    c_word_unclaim(ctx, it);
+
+    str_dtor(obj);
+    str_printf(obj, "reused");
+    c_word_add(ctx, obj);
+    if (c_word_num(ctx) != n || c_word_get(ctx, id) || c_word_find(ctx, "reused") != c_word_at(ctx, 1))
+    {
+        printf("c_word_claim %zu\n", c_word_num(ctx));
+    }
+
+    c_word_erase(ctx, 0);
+    id = c_word_id(ctx, n - 1);
+    if (c_word_compact(ctx) != 1 || c_word_num(ctx) != n - 1 || c_word_get(ctx, id))
+    {
+        printf("c_word_compact %zu\n", c_word_num(ctx));
+    }
+    if (c_word_find(ctx, "reused") != c_word_at(ctx, 0) || c_word_find(ctx, "2") != c_word_at(ctx, 1))
+    {
+        printf("c_word_compact\n");
+    }
+
+    str_dtor(obj);
+    c_word_dtor(ctx);
+}
+
+/* short strings live inside str_s, longer ones move to the heap */
+static void test_sso(void)
+{
+    str_s str[1] = {STR_NIL};
+    str_s cpy[1];
+    char buf[0x40];
+
+    for (size_t i = 0; i != sizeof(buf) - 1; ++i)
+    {
+        buf[i] = (char)('a' + i % 26);
+        buf[i + 1] = 0;
+        str_putc(str, buf[i]);
+        str_copy(cpy, str);
+        if (str_len(str) != i + 1 || strcmp(str_val(str), buf) || str_cmp(cpy, str) ||
+            (str_sso(str) != 0) != (i + 1 < STR_SSO))
+        {
+            printf("str_putc %zu\n", i);
+        }
+        str_dtor(cpy);
+    }
+    str_dtor(str);
+
+    str_puts(str, "sha256");
+    str_printf(str, "-%u", 512u);
+    str_move(cpy, str);
+    char *out = str_exit(cpy);
+    if (str_val(str) || strcmp(out, "sha256-512"))
+    {
+        printf("str_exit %s\n", out);
+    }
+    free(out);
+}
+
+/* a bulk load reserves its entries once and trims the rest at the end */
+static void test_reserve(size_t n)
+{
+    c_word_s ctx[1];
+
+    c_word_ctor(ctx);
+    if (c_word_reserve(ctx, n) || c_word_mem(ctx) != n || c_word_num(ctx) != 0)
+    {
+        printf("c_word_reserve %zu\n", c_word_mem(ctx));
+    }
+    str_s *obj = c_word_append_n(ctx, n >> 1);
+    for (size_t i = 0; i != n >> 1; ++i)
+    {
+        str_printf(obj + i, "%zu", i);
+    }
+    if (c_word_mem(ctx) != n || c_word_num(ctx) != n >> 1)
+    {
+        printf("c_word_append_n %zu\n", c_word_num(ctx));
+    }
+    if (c_word_shrink_to_fit(ctx) || c_word_mem(ctx) != n >> 1)
+    {
+        printf("c_word_shrink_to_fit %zu\n", c_word_mem(ctx));
+    }
+    if (strcmp(str_val(c_word_at(ctx, (n >> 1) - 1)), "127") != 0)
+    {
+        printf("c_word_shrink_to_fit %s\n", str_val(c_word_at(ctx, (n >> 1) - 1)));
+    }
+    c_word_dtor(ctx);
+}
+
+static void test_search(size_t n)
+{
+    c_word_s ctx[1];
+    str_s obj[1];
+
+    c_word_ctor(ctx);
+    str_ctor(obj);
+    for (size_t i = 0; i != n; ++i)
+    {
+        str_dtor(obj);
+        str_printf(obj, "%zu", i * 7);
+        c_word_add(ctx, obj);
+    }
+    /* 1232 and 1239 are the words of 176 and 177 */
+    size_t idx = c_word_search(ctx, "123", 0);
+    if (idx != 176 || c_word_search(ctx, "123", idx + 1) != 177)
+    {
+        printf("c_word_search %zu\n", idx);
+    }
+    c_word_erase(ctx, 177);
+    str_dtor(obj);
+    str_printf(obj, "x123");
+    c_word_add(ctx, obj);
+    c_word_swap(ctx, 177, 1);
+    if (c_word_search(ctx, "123", 0) != 1 || c_word_search(ctx, "x12", 2) != c_word_num(ctx))
+    {
+        printf("c_word_search %zu\n", c_word_search(ctx, "123", 0));
+    }
+
+    str_dtor(obj);
+    c_word_dtor(ctx);
+}
+
 int main(void)
 {
     test(0xFF);
+    test_set(0x1000);
+    test_slot(0x100);
+    test_sso();
+    test_reserve(0x100);
+    test_search(0x400);
     return 0;
 }
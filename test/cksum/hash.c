@@ -4,10 +4,13 @@
  @copyright Copyright (C) 2020-present tqfx, All rights reserved.
 */
 
-#include "cksum/hash.h"
+#include "cksum/util/state.h"
+#include "cksum/util/hash.h"
 
 #include "hash.h"
 
+#include <stdlib.h>
+
 #if defined(__GNUC__) || defined(__clang__)
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpadded"
@@ -1357,6 +1360,166 @@ static void test_blake2b_512(void)
 #pragma GCC diagnostic pop
 #endif /* __GNUC__ || __clang__ */
 
+static void test_file(void)
+{
+    const char *fname = "hash.bin";
+    /* spans several read blocks and ends with a partial one */
+    size_t nbyte = 0x40000 * 3 + 0x123;
+    unsigned char *pdata = (unsigned char *)malloc(nbyte);
+    if (pdata == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i != nbyte; ++i)
+    {
+        pdata[i] = (unsigned char)(i * 31 + (i >> 8));
+    }
+    FILE *out = fopen(fname, "wb");
+    if (out)
+    {
+        fwrite(pdata, 1, nbyte, out);
+        fclose(out);
+
+        unsigned char src[SHA256_OUTSIZ];
+        unsigned char dst[SHA256_OUTSIZ];
+        size_t siz = sizeof(src);
+        hash_memory(&hash_sha256, pdata, nbyte, src, &siz);
+        siz = sizeof(dst);
+        hash_file(&hash_sha256, fname, dst, &siz);
+        HASH_DIFF(src, dst, SHA256_OUTSIZ, "hash_file");
+
+        remove(fname);
+    }
+    free(pdata);
+}
+
+static void test_state(void)
+{
+    static const hash_s *const hash[] = {
+        &hash_md5,
+        &hash_sha1,
+        &hash_sha256,
+        &hash_sha512_224,
+        &hash_sha3_256,
+        &hash_shake128,
+        &hash_keccak512,
+        &hash_blake2s_160,
+        &hash_blake2b_512,
+    };
+    const char *msg = "1234567890123456789012345678901234567890"
+                      "1234567890123456789012345678901234567890"
+                      "1234567890123456789012345678901234567890"
+                      "1234567890123456789012345678901234567890";
+    size_t len = strlen(msg);
+
+    for (unsigned int i = 0; i != sizeof(hash) / sizeof(*hash); ++i)
+    {
+        unsigned char src[HASH_BUFSIZ];
+        unsigned char dst[HASH_BUFSIZ];
+        unsigned char buf[HASH_STATE_BUFSIZ];
+        size_t siz = sizeof(buf);
+        hash_u ctx[1];
+
+        hash[i]->init(ctx);
+        hash[i]->proc(ctx, msg, len);
+        hash[i]->done(ctx, src);
+
+        /* checkpoint in the middle of a block, resume from a blank state */
+        hash[i]->init(ctx);
+        hash[i]->proc(ctx, msg, 77);
+        hash_state_export(hash[i], ctx, buf, &siz);
+        memset(ctx, 0xFF, sizeof(ctx));
+        if (hash_state_import(hash[i], ctx, buf, siz))
+        {
+            printf("hash_state_import %u\n", i);
+            continue;
+        }
+        hash[i]->proc(ctx, msg + 77, len - 77);
+        hash[i]->done(ctx, dst);
+        HASH_DIFF(src, dst, hash[i]->outsiz, "hash_state");
+
+        if (hash_state_import(hash[(i + 1) % (sizeof(hash) / sizeof(*hash))], ctx, buf, siz) == 0)
+        {
+            printf("hash_state_import %u mismatch\n", i);
+        }
+    }
+}
+
+static void test_conv(void)
+{
+    unsigned char src[0x81];
+    unsigned char dst[0x81 * 2];
+    char hex[0x81 * 2 + 1];
+    char ref[0x81 * 2 + 1];
+
+    for (unsigned int i = 0; i != sizeof(src); ++i)
+    {
+        src[i] = (unsigned char)(i * 97 + 13);
+    }
+    /* every length exercises the vector blocks and the scalar tail */
+    for (size_t n = 0; n != sizeof(src); ++n)
+    {
+        for (unsigned int cases = 0; cases != 2; ++cases)
+        {
+            for (size_t i = 0; i != n; ++i)
+            {
+                sprintf(ref + (i << 1), cases ? "%02X" : "%02x", src[i]);
+            }
+            *hex_encode(src, n, cases, hex) = 0;
+            if (memcmp(hex, ref, n << 1))
+            {
+                printf("hex_encode %zu %u\n", n, cases);
+            }
+            if (hex_decode(hex, n << 1, dst) || memcmp(src, dst, n))
+            {
+                printf("hex_decode %zu %u\n", n, cases);
+            }
+            if (hex_xdigits(hex, n << 1, dst))
+            {
+                printf("hex_xdigits %zu %u\n", n, cases);
+            }
+            for (size_t i = 0; i != n << 1; ++i)
+            {
+                if (dst[i] != xdigit(hex[i]))
+                {
+                    printf("hex_xdigits %zu %u\n", n, cases);
+                    break;
+                }
+            }
+        }
+    }
+
+    /* every character that is not hexadecimal is rejected wherever it is */
+    digest_lower(src, sizeof(src), hex);
+    for (size_t i = 0; i < sizeof(src) << 1; i += 7)
+    {
+        static const char bad[] = {'/', ':', '@', 'G', '`', 'g', ' ', '\x80', '\xC1'};
+        char c = hex[i];
+        hex[i] = bad[i % sizeof(bad)];
+        if (hex_decode(hex, sizeof(src) << 1, dst) == 0 ||
+            hex_xdigits(hex, sizeof(src) << 1, dst) == 0)
+        {
+            printf("hex_decode %zu %c\n", i, hex[i]);
+        }
+        hex[i] = c;
+    }
+    if (hex_decode(hex, 3, dst) == 0)
+    {
+        printf("hex_decode odd\n");
+    }
+
+    char *batch = (char *)digests(src, 0x20, 4, 1, 0);
+    for (unsigned int i = 0; i != 4; ++i)
+    {
+        digest_upper(src + 0x20 * i, 0x20, ref);
+        if (strcmp(batch + 0x41 * i, ref))
+        {
+            printf("digests %u\n", i);
+        }
+    }
+    free(batch);
+}
+
 int main(void)
 {
     test_md5();
@@ -1390,5 +1553,9 @@ int main(void)
     test_blake2b_384();
     test_blake2b_512();
 
+    test_file();
+    test_state();
+    test_conv();
+
     return 0;
 }
@@ -4,10 +4,16 @@
  @copyright Copyright (C) 2020-present tqfx, All rights reserved.
 */
 
+#include "cksum/util/hkdf.h"
+#include "cksum/util/hmac.h"
+#include "cksum/util/hash.h"
+#include "cksum/pbkdf2.h"
 #include "cksum/hmac.h"
 
 #include "hash.h"
 
+#include <stdlib.h>
+
 static const char *key = "12345678901234567890123456789012345678901234567890123456789012345678901234567890";
 static const char *msg = "text";
 
@@ -265,6 +271,251 @@ static void test_hmac_blake2b(void)
     HASH_DIFF(ctx->buf, hash, sizeof(hash), "hmac_blake2b_512");
 }
 
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+#endif /* __GNUC__ || __clang__ */
+
+static void test_pbkdf2(void)
+{
+    static const struct
+    {
+        const hash_s *hash;
+        const char *key;
+        const char *salt;
+        size_t iter;
+        size_t size;
+        unsigned char out[100];
+    } tests[] = {
+        /* clang-format off */
+        {
+            &hash_sha1, "password", "salt", 4096, 20,
+            {
+                0x4B, 0x00, 0x79, 0x01, 0xB7, 0x65, 0x48, 0x9A,
+                0xBE, 0xAD, 0x49, 0xD9, 0x26, 0xF7, 0x21, 0xD0,
+                0x65, 0xA4, 0x29, 0xC1,
+            },
+        },
+        {
+            &hash_sha1, "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 25,
+            {
+                0x3D, 0x2E, 0xEC, 0x4F, 0xE4, 0x1C, 0x84, 0x9B,
+                0x80, 0xC8, 0xD8, 0x36, 0x62, 0xC0, 0xE4, 0x4A,
+                0x8B, 0x29, 0x1A, 0x96, 0x4C, 0xF2, 0xF0, 0x70,
+                0x38,
+            },
+        },
+        {
+            &hash_md5, "password", "salt", 1000, 16,
+            {
+                0x8D, 0x18, 0x99, 0x46, 0xA3, 0x2D, 0x88, 0x36,
+                0x22, 0xA1, 0x6A, 0xE1, 0x8A, 0xF0, 0x63, 0x2F,
+            },
+        },
+        {
+            &hash_sha224, "password", "salt", 1000, 40,
+            {
+                0xD3, 0xBC, 0xF3, 0x20, 0xFD, 0x91, 0x89, 0x08,
+                0xEA, 0xFC, 0xAA, 0x46, 0x0F, 0xAF, 0x40, 0xE2,
+                0x01, 0xF6, 0x50, 0x8D, 0x4E, 0x6F, 0x3D, 0x9C,
+                0x1C, 0x0A, 0xBD, 0x30, 0xDA, 0xE0, 0x8C, 0xC8,
+                0xB1, 0xBC, 0x06, 0x57, 0xE2, 0xEB, 0xC2, 0x29,
+            },
+        },
+        {
+            &hash_sha256, "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 40,
+            {
+                0x34, 0x8C, 0x89, 0xDB, 0xCB, 0xD3, 0x2B, 0x2F,
+                0x32, 0xD8, 0x14, 0xB8, 0x11, 0x6E, 0x84, 0xCF,
+                0x2B, 0x17, 0x34, 0x7E, 0xBC, 0x18, 0x00, 0x18,
+                0x1C, 0x4E, 0x2A, 0x1F, 0xB8, 0xDD, 0x53, 0xE1,
+                0xC6, 0x35, 0x51, 0x8C, 0x7D, 0xAC, 0x47, 0xE9,
+            },
+        },
+        {
+            &hash_sha512, "password", "salt", 1000, 100,
+            {
+                0xAF, 0xE6, 0xC5, 0x53, 0x07, 0x85, 0xB6, 0xCC,
+                0x6B, 0x1C, 0x64, 0x53, 0x38, 0x47, 0x31, 0xBD,
+                0x5E, 0xE4, 0x32, 0xEE, 0x54, 0x9F, 0xD4, 0x2F,
+                0xB6, 0x69, 0x57, 0x79, 0xAD, 0x8A, 0x1C, 0x5B,
+                0xF5, 0x9D, 0xE6, 0x9C, 0x48, 0xF7, 0x74, 0xEF,
+                0xC4, 0x00, 0x7D, 0x52, 0x98, 0xF9, 0x03, 0x3C,
+                0x02, 0x41, 0xD5, 0xAB, 0x69, 0x30, 0x5E, 0x7B,
+                0x64, 0xEC, 0xEE, 0xB8, 0xD8, 0x34, 0xCF, 0xEC,
+                0x6A, 0xFD, 0xEC, 0x3C, 0x1C, 0x23, 0x98, 0x2A,
+                0x12, 0x1F, 0x2D, 0x4B, 0xE0, 0x08, 0x88, 0x93,
+                0x78, 0xA4, 0x9A, 0x0D, 0xFB, 0x10, 0x4F, 0x0D,
+                0x28, 0x56, 0xE3, 0x8F, 0x44, 0x27, 0x1C, 0xDA,
+                0xF6, 0xDE, 0x43, 0x41,
+            },
+        },
+        {
+            &hash_sha512_224, "password", "salt", 1000, 28,
+            {
+                0x2F, 0x7D, 0xD7, 0x17, 0x2B, 0x03, 0x24, 0xE8,
+                0x23, 0x4F, 0xB8, 0x7A, 0x2A, 0x78, 0x9B, 0x8C,
+                0xA2, 0x0F, 0x61, 0x3F, 0xB0, 0x43, 0xBE, 0x22,
+                0x8E, 0x1E, 0xDB, 0xFC,
+            },
+        },
+        {
+            &hash_sha3_256, "password", "salt", 1000, 48,
+            {
+                0xEE, 0x56, 0xA9, 0xB7, 0x31, 0x1B, 0xB0, 0x81,
+                0xD0, 0xBB, 0xFA, 0x8D, 0xC3, 0xC2, 0x79, 0x8F,
+                0x30, 0xAB, 0xBB, 0xEC, 0x63, 0x44, 0x42, 0x68,
+                0x29, 0xD9, 0x56, 0xED, 0x06, 0xEA, 0xEC, 0xAB,
+                0xAB, 0xEA, 0x95, 0x4D, 0x5C, 0xE1, 0x72, 0x17,
+                0x27, 0x7A, 0x9F, 0x06, 0x33, 0x59, 0xCD, 0xF7,
+            },
+        },
+        /* clang-format on */
+    };
+
+    for (unsigned int i = 0; i != sizeof(tests) / sizeof(*tests); ++i)
+    {
+        unsigned char out[sizeof(tests[i].out)];
+        pbkdf2(tests[i].hash, tests[i].key, strlen(tests[i].key),
+               tests[i].salt, strlen(tests[i].salt), tests[i].iter, out, tests[i].size);
+        HASH_DIFF(out, tests[i].out, tests[i].size, "pbkdf2");
+    }
+
+    /* the passwords spread across the lanes give the same keys as one by one,
+       with three blocks each, some of them span two batches */
+    const void *pkey[] = {"password", "passwordPASSWORDpassword", "pass", "word", "12345"};
+    size_t nkey[] = {8, 24, 4, 4, 5};
+    unsigned char out[sizeof(pkey) / sizeof(*pkey)][70];
+    pbkdf2_multi(&hash_sha256, pkey, nkey, sizeof(pkey) / sizeof(*pkey), "salt", 4, 100, out, sizeof(*out));
+    for (unsigned int i = 0; i != sizeof(pkey) / sizeof(*pkey); ++i)
+    {
+        unsigned char dst[sizeof(*out)];
+        pbkdf2(&hash_sha256, pkey[i], nkey[i], "salt", 4, 100, dst, sizeof(dst));
+        HASH_DIFF(out[i], dst, sizeof(dst), "pbkdf2_multi");
+    }
+    /* keys of no length for more passwords than there are lanes */
+    const void *many[] = {"a", "b", "c", "d", "e", "f", "g", "h", "i"};
+    size_t nmany[] = {1, 1, 1, 1, 1, 1, 1, 1, 1};
+    if (pbkdf2_multi(&hash_sha256, many, nmany, sizeof(many) / sizeof(*many), "salt", 4, 100, 0, 0))
+    {
+        printf("pbkdf2_multi empty\n");
+    }
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif /* __GNUC__ || __clang__ */
+
+static void test_hkdf(void)
+{
+    static const unsigned char prk[] = {
+        /* clang-format off */
+        0x07, 0x77, 0x09, 0x36, 0x2C, 0x2E, 0x32, 0xDF,
+        0x0D, 0xDC, 0x3F, 0x0D, 0xC4, 0x7B, 0xBA, 0x63,
+        0x90, 0xB6, 0xC7, 0x3B, 0xB5, 0x0F, 0x9C, 0x31,
+        0x22, 0xEC, 0x84, 0x4A, 0xD7, 0xC2, 0xB3, 0xE5,
+        /* clang-format on */
+    };
+    static const unsigned char okm1[] = {
+        /* clang-format off */
+        0x3C, 0xB2, 0x5F, 0x25, 0xFA, 0xAC, 0xD5, 0x7A,
+        0x90, 0x43, 0x4F, 0x64, 0xD0, 0x36, 0x2F, 0x2A,
+        0x2D, 0x2D, 0x0A, 0x90, 0xCF, 0x1A, 0x5A, 0x4C,
+        0x5D, 0xB0, 0x2D, 0x56, 0xEC, 0xC4, 0xC5, 0xBF,
+        0x34, 0x00, 0x72, 0x08, 0xD5, 0xB8, 0x87, 0x18,
+        0x58, 0x65,
+        /* clang-format on */
+    };
+    static const unsigned char okm3[] = {
+        /* clang-format off */
+        0x8D, 0xA4, 0xE7, 0x75, 0xA5, 0x63, 0xC1, 0x8F,
+        0x71, 0x5F, 0x80, 0x2A, 0x06, 0x3C, 0x5A, 0x31,
+        0xB8, 0xA1, 0x1F, 0x5C, 0x5E, 0xE1, 0x87, 0x9E,
+        0xC3, 0x45, 0x4E, 0x5F, 0x3C, 0x73, 0x8D, 0x2D,
+        0x9D, 0x20, 0x13, 0x95, 0xFA, 0xA4, 0xB6, 0x1A,
+        0x96, 0xC8,
+        /* clang-format on */
+    };
+
+    /* RFC 5869 test case 1 */
+    unsigned char ikm[22];
+    unsigned char salt[13];
+    unsigned char info[10];
+    memset(ikm, 0x0B, sizeof(ikm));
+    for (unsigned int i = 0; i != sizeof(salt); ++i)
+    {
+        salt[i] = (unsigned char)i;
+    }
+    for (unsigned int i = 0; i != sizeof(info); ++i)
+    {
+        info[i] = (unsigned char)(0xF0 + i);
+    }
+
+    unsigned char out[sizeof(okm1)];
+    size_t siz = SHA256_OUTSIZ;
+    hkdf_extract(&hash_sha256, salt, sizeof(salt), ikm, sizeof(ikm), out, &siz);
+    HASH_DIFF(out, prk, sizeof(prk), "hkdf_extract");
+
+    /* the prepared key state is reused for every expand */
+    hmac_s ctx[1];
+    hkdf_init(ctx, &hash_sha256, prk, sizeof(prk));
+    for (unsigned int i = 0; i != 2; ++i)
+    {
+        memset(out, 0, sizeof(out));
+        hkdf_expand(ctx, info, sizeof(info), out, sizeof(out));
+        HASH_DIFF(out, okm1, sizeof(okm1), "hkdf_expand");
+    }
+    if (hkdf_expand(ctx, info, sizeof(info), out, 0xFF * SHA256_OUTSIZ + 1) == 0)
+    {
+        printf("hkdf_expand overflow\n");
+    }
+
+    /* RFC 5869 test case 3 */
+    hkdf(&hash_sha256, 0, 0, ikm, sizeof(ikm), 0, 0, out, sizeof(okm3));
+    HASH_DIFF(out, okm3, sizeof(okm3), "hkdf");
+}
+
+static void test_file(void)
+{
+    const char *fname = "hmac.bin";
+    /* spans several read blocks and ends with a partial one */
+    size_t nbyte = 0x40000 * 3 + 0x123;
+    unsigned char *pdata = (unsigned char *)malloc(nbyte);
+    if (pdata == 0)
+    {
+        return;
+    }
+    for (size_t i = 0; i != nbyte; ++i)
+    {
+        pdata[i] = (unsigned char)(i * 31 + (i >> 8));
+    }
+    FILE *out = fopen(fname, "wb");
+    if (out)
+    {
+        fwrite(pdata, 1, nbyte, out);
+        fclose(out);
+
+        unsigned char src[SHA256_OUTSIZ];
+        unsigned char dst[SHA256_OUTSIZ];
+        size_t siz = sizeof(src);
+        hmac_memory(&hash_sha256, key, strlen(key), pdata, nbyte, src, &siz);
+        siz = sizeof(dst);
+        hmac_file(&hash_sha256, key, strlen(key), fname, dst, &siz);
+        HASH_DIFF(src, dst, SHA256_OUTSIZ, "hmac_file");
+
+        /* a released reader is set up again by the next read */
+        hash_file_release();
+        memset(dst, 0, sizeof(dst));
+        siz = sizeof(dst);
+        hmac_file(&hash_sha256, key, strlen(key), fname, dst, &siz);
+        HASH_DIFF(src, dst, SHA256_OUTSIZ, "hash_file_release");
+        hash_file_release();
+
+        remove(fname);
+    }
+    free(pdata);
+}
+
 int main(void)
 {
     test_hmac_md5();
@@ -284,5 +535,9 @@ int main(void)
     test_hmac_blake2s();
     test_hmac_blake2b();
 
+    test_pbkdf2();
+    test_hkdf();
+    test_file();
+
     return 0;
 }
@@ -26,6 +26,8 @@ target("cipher")
 
     add_defines("_POSIX_C_SOURCE=200809L")
 
+    check_cincludes("HAS_IO_URING_H", "linux/io_uring.h")
+
     add_includedirs("lib", {private = true})
 
     add_includedirs("include", {public = true})